@@ -0,0 +1,175 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "parallel.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Таблица кратчайших путей между всеми парами вершин, как у Router, но
+// в плоских массивах: на пару приходится вес float и 32-битный номер
+// последнего ребра пути — 8 байт вместо примерно 32 у Router. Строки
+// считаются независимыми поисками Дейкстры из каждой вершины параллельно,
+// что для разреженного графа быстрее алгоритма Флойда–Уоршелла.
+//
+// Маршрут из BuildRoute имеет точный вес: рёбра пути суммируются заново
+// в Weight. GetRouteWeight возвращает вес из таблицы с точностью float
+// (относительная погрешность около 1e-7).
+template <typename Weight>
+class AllPairsTable {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    explicit AllPairsTable(const Graph& graph, size_t thread_count = parallel::GetDefaultThreadCount());
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
+    // Обновляет таблицу после изменения весов рёбер графа (число вершин
+    // прежнее). Пересчитываются только строки, чьё дерево кратчайших путей
+    // перестало быть точным; возвращает их число.
+    size_t Update(const std::vector<EdgeWeightChange<Weight>>& changes,
+                  size_t thread_count = parallel::GetDefaultThreadCount());
+
+    size_t GetMemoryUsage() const {
+        return weights_.capacity() * sizeof(float) + prev_edges_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    // Ребро для недостижимой пары и для пары (v, v)
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+    static constexpr float INFINITE_WEIGHT = std::numeric_limits<float>::infinity();
+    // Относительный запас на округление весов до float при проверке строк
+    static constexpr double ROUNDING_SLACK = 1e-6;
+
+    void FillRows(const std::vector<VertexId>& rows, size_t thread_count);
+    bool IsRowValidAfter(VertexId from, const std::vector<EdgeWeightChange<Weight>>& changes) const;
+
+    size_t GetIndex(VertexId from, VertexId to) const {
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        return from * vertex_count_ + to;
+    }
+
+    const Graph& graph_;
+    size_t vertex_count_;
+    std::vector<float> weights_;       // [from * V + to], INFINITE_WEIGHT — пути нет
+    std::vector<uint32_t> prev_edges_;  // [from * V + to], последнее ребро пути
+};
+
+template <typename Weight>
+AllPairsTable<Weight>::AllPairsTable(const Graph& graph, size_t thread_count)
+    : graph_(graph)
+    , vertex_count_(graph.GetVertexCount())
+{
+    if (graph.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for 32-bit edge ids");
+    }
+    weights_.resize(vertex_count_ * vertex_count_);
+    prev_edges_.resize(vertex_count_ * vertex_count_);
+
+    std::vector<VertexId> rows(vertex_count_);
+    for (VertexId from = 0; from < vertex_count_; ++from) {
+        rows[from] = from;
+    }
+    FillRows(rows, thread_count);
+}
+
+template <typename Weight>
+void AllPairsTable<Weight>::FillRows(const std::vector<VertexId>& rows, size_t thread_count) {
+    const DijkstraRouter<Weight> router(graph_);
+    parallel::ForEachIndex(rows.size(), [&](size_t index) {
+        const VertexId from = rows[index];
+        const auto tree = router.BuildShortestPathTree(from);
+        float* weights = weights_.data() + from * vertex_count_;
+        uint32_t* prev_edges = prev_edges_.data() + from * vertex_count_;
+        for (VertexId to = 0; to < vertex_count_; ++to) {
+            const bool reachable = tree.IsReachable(to);
+            weights[to] = reachable ? static_cast<float>(tree.weights[to]) : INFINITE_WEIGHT;
+            prev_edges[to] = reachable && tree.prev_edges[to] != tree.NO_EDGE
+                ? static_cast<uint32_t>(tree.prev_edges[to]) : NO_EDGE;
+        }
+    }, thread_count);
+}
+
+// См. ShortestPathTree::IsValidAfter; из-за округления до float строка
+// считается устаревшей и при почти равных весах
+template <typename Weight>
+bool AllPairsTable<Weight>::IsRowValidAfter(VertexId from,
+                                            const std::vector<EdgeWeightChange<Weight>>& changes) const {
+    const size_t row = from * vertex_count_;
+    for (const auto& [edge_id, old_weight] : changes) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        if (prev_edges_[row + edge.to] == edge_id) {
+            return false;
+        }
+        const double from_weight = weights_[row + edge.from];
+        const double to_weight = weights_[row + edge.to];
+        if (edge.weight < old_weight && from_weight != INFINITE_WEIGHT
+            && from_weight + edge.weight < to_weight * (1 + ROUNDING_SLACK)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+size_t AllPairsTable<Weight>::Update(const std::vector<EdgeWeightChange<Weight>>& changes, size_t thread_count) {
+    if (graph_.GetVertexCount() != vertex_count_) {
+        throw std::logic_error("Vertex count of the graph has changed");
+    }
+    std::vector<VertexId> rows;
+    for (VertexId from = 0; from < vertex_count_; ++from) {
+        if (!IsRowValidAfter(from, changes)) {
+            rows.push_back(from);
+        }
+    }
+    FillRows(rows, thread_count);
+    return rows.size();
+}
+
+template <typename Weight>
+std::optional<Weight> AllPairsTable<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    const float weight = weights_[GetIndex(from, to)];
+    if (weight == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+    return static_cast<Weight>(weight);
+}
+
+template <typename Weight>
+std::optional<typename AllPairsTable<Weight>::RouteInfo> AllPairsTable<Weight>::BuildRoute(
+    VertexId from, VertexId to) const {
+    const size_t row = GetIndex(from, to) - to;
+    if (weights_[row + to] == INFINITE_WEIGHT) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = prev_edges_[row + to]; edge_id != NO_EDGE;) {
+        edges.push_back(edge_id);
+        edge_id = prev_edges_[row + graph_.GetEdge(edge_id).from];
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    Weight weight{};
+    for (const EdgeId edge_id : edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -0,0 +1,567 @@
+#include "catalogue_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TransportCatalog {
+namespace Transport {
+
+namespace {
+
+constexpr char IMAGE_MAGIC[8] = {'T', 'C', 'I', 'M', 'A', 'G', 'E', '\0'};
+// Читается как другое число, если образ записан машиной с другим порядком байт
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t NO_IMAGE_VERTEX = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_IMAGE_BUS = std::numeric_limits<uint32_t>::max();
+
+// Смещения и цели дуг читаются из файла как массивы CsrGraph
+static_assert(sizeof(size_t) == sizeof(uint64_t) && sizeof(graph::VertexId) == sizeof(uint64_t),
+              "Catalogue image stores 64-bit CSR offsets and vertex ids");
+
+enum Section : size_t {
+    STRINGS,           // char: имена остановок и автобусов подряд
+    STOPS,             // StopRecord по StopId
+    STOP_NAME_INDEX,   // uint32_t: StopId по алфавиту имен
+    BUSES,             // BusRecord по BusId
+    BUS_NAME_INDEX,    // uint32_t: BusId по алфавиту имен
+    BUS_STOPS,         // uint32_t: остановки автобусов подряд
+    STOP_BUS_OFFSETS,  // uint32_t: начало автобусов остановки в STOP_BUSES, stop_count + 1
+    STOP_BUSES,        // uint32_t: BusId по алфавиту имен для каждой остановки
+    DISTANCES,         // DistanceRecord по возрастанию (from, to)
+    MAP,               // char: SVG-карта
+    VERTEX_STOPS,      // uint32_t: StopId вершины графа
+    STOP_VERTICES,     // uint32_t: вершина остановки, NO_IMAGE_VERTEX — остановки нет в графе
+    ARC_OFFSETS,       // size_t: начало исходящих дуг вершины, vertex_count + 1
+    ARC_TARGETS,       // VertexId: конец дуги
+    ARC_WEIGHTS,       // double: время по дуге в минутах
+    ARC_BUSES,         // uint32_t: BusId дуги, NO_IMAGE_BUS — ожидание или посадка
+    ARC_SPAN_COUNTS,   // int32_t: число пролётов, 0 у высадки в компактной модели
+    SECTION_COUNT,
+};
+
+struct SectionRecord {
+    uint64_t offset;
+    uint64_t size;  // в байтах
+};
+
+uint32_t ToUint32(size_t value) {
+    if (value >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Catalogue is too large for the binary image");
+    }
+    return static_cast<uint32_t>(value);
+}
+
+} // namespace
+
+struct CatalogueImage::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint32_t stop_count;
+    uint32_t bus_count;
+    uint32_t vertex_count;
+    uint32_t reserved;
+    uint64_t arc_count;
+    uint64_t distance_count;
+    SectionRecord sections[SECTION_COUNT];
+};
+
+struct CatalogueImage::StopRecord {
+    double latitude;
+    double longitude;
+    uint32_t name_offset;
+    uint32_t name_size;
+};
+
+struct CatalogueImage::BusRecord {
+    uint32_t name_offset;
+    uint32_t name_size;
+    uint32_t first_stop;  // в BUS_STOPS
+    uint32_t stop_count;
+    uint32_t is_circular;
+    int32_t stops_on_route;
+    int32_t unique_stops;
+    uint32_t reserved;
+    double route_length;
+    double geo_length;
+    double curvature;
+};
+
+struct CatalogueImage::DistanceRecord {
+    uint32_t from;
+    uint32_t to;
+    int32_t distance;
+};
+
+// Секции пишутся подряд с выравниванием по 8 байт, заголовок — последним,
+// когда известны их смещения
+void CatalogueImage::Write(const std::string& path, const CatalogueSnapshot& db, const TransportRouter& router,
+                           std::string_view map_svg) {
+    const auto& stops = db.GetAllStops();
+    const auto& buses = db.GetAllBuses();
+
+    std::vector<char> strings;
+    auto add_string = [&strings](std::string_view value) {
+        const uint32_t offset = ToUint32(strings.size());
+        strings.insert(strings.end(), value.begin(), value.end());
+        return offset;
+    };
+
+    std::vector<StopRecord> stop_records;
+    stop_records.reserve(stops.size());
+    for (const Domain::Stop& stop : stops) {
+        stop_records.push_back({stop.coordinates.lat, stop.coordinates.lng, add_string(stop.name),
+                                ToUint32(stop.name.size())});
+    }
+
+    std::vector<BusRecord> bus_records;
+    std::vector<uint32_t> bus_stops;
+    bus_records.reserve(buses.size());
+    for (const Domain::Bus& bus : buses) {
+        const Domain::BusInfo& info = db.GetBusInfo(bus.id);
+        bus_records.push_back({add_string(bus.name), ToUint32(bus.name.size()), ToUint32(bus_stops.size()),
+                               ToUint32(bus.stops.size()), bus.is_circular, info.stops_on_route, info.unique_stops, 0,
+                               info.route_length, info.geo_length, info.curvature});
+        bus_stops.insert(bus_stops.end(), bus.stops.begin(), bus.stops.end());
+    }
+
+    auto make_name_index = [](const auto& items) {
+        std::vector<uint32_t> index(items.size());
+        for (uint32_t id = 0; id < index.size(); ++id) {
+            index[id] = id;
+        }
+        std::sort(index.begin(), index.end(), [&items](uint32_t lhs, uint32_t rhs) {
+            return items[lhs].name < items[rhs].name;
+        });
+        return index;
+    };
+    const auto stop_name_index = make_name_index(stops);
+    const auto bus_name_index = make_name_index(buses);
+
+    std::vector<uint32_t> stop_bus_offsets{0};
+    std::vector<uint32_t> stop_buses;
+    stop_bus_offsets.reserve(stops.size() + 1);
+    for (const Domain::Stop& stop : stops) {
+        for (const std::string_view bus_name : db.GetBusNamesByStop(stop.id)) {
+            stop_buses.push_back(db.FindBus(bus_name)->id);
+        }
+        stop_bus_offsets.push_back(ToUint32(stop_buses.size()));
+    }
+
+    std::vector<DistanceRecord> distances;
+    db.GetDistanceTable().ForEachExplicit([&distances](Domain::StopId from, Domain::StopId to, int distance) {
+        distances.push_back({from, to, distance});
+    });
+    std::sort(distances.begin(), distances.end(), [](const DistanceRecord& lhs, const DistanceRecord& rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    });
+
+    // Дуги вершины в порядке рёбер графа, как в CsrGraph
+    const auto graph = router.ExportGraph();
+    const size_t vertex_count = graph.vertex_to_stop.size();
+    const size_t arc_count = graph.edges.size();
+    std::vector<size_t> arc_offsets(vertex_count + 1, 0);
+    for (const auto& edge : graph.edges) {
+        ++arc_offsets[edge.from + 1];
+    }
+    for (size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        arc_offsets[vertex + 1] += arc_offsets[vertex];
+    }
+    std::vector<graph::VertexId> arc_targets(arc_count);
+    std::vector<double> arc_weights(arc_count);
+    std::vector<uint32_t> arc_buses(arc_count);
+    std::vector<int32_t> arc_span_counts(arc_count);
+    std::vector<size_t> next_arcs(arc_offsets.begin(), arc_offsets.end() - 1);
+    for (const auto& edge : graph.edges) {
+        const size_t arc = next_arcs[edge.from]++;
+        arc_targets[arc] = edge.to;
+        arc_weights[arc] = edge.weight;
+        arc_buses[arc] = edge.bus ? *edge.bus : NO_IMAGE_BUS;
+        arc_span_counts[arc] = edge.span_count;
+    }
+    std::vector<uint32_t> stop_vertices(stops.size(), NO_IMAGE_VERTEX);
+    for (size_t stop = 0; stop < std::min(stops.size(), graph.stop_to_vertex.size()); ++stop) {
+        if (graph.stop_to_vertex[stop] != TransportRouter::NO_EXPORTED_VERTEX) {
+            stop_vertices[stop] = ToUint32(graph.stop_to_vertex[stop]);
+        }
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    Header header{};
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = CATALOGUE_IMAGE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.stop_count = ToUint32(stops.size());
+    header.bus_count = ToUint32(buses.size());
+    header.vertex_count = ToUint32(vertex_count);
+    header.arc_count = arc_count;
+    header.distance_count = distances.size();
+
+    uint64_t offset = sizeof(Header);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    auto write_section = [&](Section section, const void* data, size_t size) {
+        static constexpr char PADDING[8] = {};
+        const size_t padding = (8 - offset % 8) % 8;
+        out.write(PADDING, padding);
+        offset += padding;
+        header.sections[section] = {offset, size};
+        out.write(static_cast<const char*>(data), size);
+        offset += size;
+    };
+    auto write_vector = [&write_section](Section section, const auto& items) {
+        write_section(section, items.data(), items.size() * sizeof(items[0]));
+    };
+    write_vector(STRINGS, strings);
+    write_vector(STOPS, stop_records);
+    write_vector(STOP_NAME_INDEX, stop_name_index);
+    write_vector(BUSES, bus_records);
+    write_vector(BUS_NAME_INDEX, bus_name_index);
+    write_vector(BUS_STOPS, bus_stops);
+    write_vector(STOP_BUS_OFFSETS, stop_bus_offsets);
+    write_vector(STOP_BUSES, stop_buses);
+    write_vector(DISTANCES, distances);
+    write_section(MAP, map_svg.data(), map_svg.size());
+    write_vector(VERTEX_STOPS, graph.vertex_to_stop);
+    write_vector(STOP_VERTICES, stop_vertices);
+    write_vector(ARC_OFFSETS, arc_offsets);
+    write_vector(ARC_TARGETS, arc_targets);
+    write_vector(ARC_WEIGHTS, arc_weights);
+    write_vector(ARC_BUSES, arc_buses);
+    write_vector(ARC_SPAN_COUNTS, arc_span_counts);
+
+    header.file_size = offset;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out.flush()) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+}
+
+CatalogueImage::CatalogueImage(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a catalogue image");
+    }
+    size_ = file_stat.st_size;
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path);
+    }
+    data_ = static_cast<const char*>(data);
+
+    header_ = reinterpret_cast<const Header*>(data_);
+    try {
+        if (std::memcmp(header_->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header_->file_size != size_) {
+            throw std::runtime_error(path + " is not a catalogue image");
+        }
+        if (header_->version != CATALOGUE_IMAGE_VERSION || header_->byte_order != BYTE_ORDER_MARK) {
+            throw std::runtime_error(path + " has unsupported image version or byte order");
+        }
+        const size_t stop_count = header_->stop_count;
+        const size_t bus_count = header_->bus_count;
+        const size_t vertex_count = header_->vertex_count;
+        strings_ = GetSection<char>(STRINGS, header_->sections[STRINGS].size);
+        stops_ = GetSection<StopRecord>(STOPS, stop_count);
+        stop_name_index_ = GetSection<uint32_t>(STOP_NAME_INDEX, stop_count);
+        buses_ = GetSection<BusRecord>(BUSES, bus_count);
+        bus_name_index_ = GetSection<uint32_t>(BUS_NAME_INDEX, bus_count);
+        bus_stops_ = GetSection<uint32_t>(BUS_STOPS, header_->sections[BUS_STOPS].size / sizeof(uint32_t));
+        stop_bus_offsets_ = GetSection<uint32_t>(STOP_BUS_OFFSETS, stop_count + 1);
+        stop_buses_ = GetSection<uint32_t>(STOP_BUSES, stop_bus_offsets_[stop_count]);
+        distances_ = GetSection<DistanceRecord>(DISTANCES, header_->distance_count);
+        map_ = GetSection<char>(MAP, header_->sections[MAP].size);
+        vertex_stops_ = GetSection<uint32_t>(VERTEX_STOPS, vertex_count);
+        stop_vertices_ = GetSection<uint32_t>(STOP_VERTICES, stop_count);
+        const size_t arc_count = header_->arc_count;
+        arc_offsets_ = GetSection<size_t>(ARC_OFFSETS, vertex_count + 1);
+        arc_targets_ = GetSection<graph::VertexId>(ARC_TARGETS, arc_count);
+        arc_weights_ = GetSection<double>(ARC_WEIGHTS, arc_count);
+        arc_buses_ = GetSection<uint32_t>(ARC_BUSES, arc_count);
+        arc_span_counts_ = GetSection<int32_t>(ARC_SPAN_COUNTS, arc_count);
+        if (!HasValidIndices()) {
+            throw std::runtime_error(path + " has out of range indices");
+        }
+        router_ = std::make_unique<graph::DijkstraRouter<double>>(
+            graph::CsrGraph<double>::View(vertex_count, arc_offsets_, arc_targets_, arc_weights_),
+            graph::CsrDirection::OUTGOING);
+    } catch (...) {
+        ::munmap(const_cast<char*>(data_), size_);
+        throw;
+    }
+}
+
+CatalogueImage::~CatalogueImage() {
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+// Секция должна лежать в файле целиком, быть выровнена под запись и
+// вмещать ровно count записей
+template <typename Record>
+const Record* CatalogueImage::GetSection(size_t section, size_t count) const {
+    const SectionRecord& record = header_->sections[section];
+    if (record.offset > size_ || record.size > size_ - record.offset || record.offset % alignof(Record) != 0
+        || record.size != count * sizeof(Record)) {
+        throw std::runtime_error("Catalogue image section is corrupted");
+    }
+    return reinterpret_cast<const Record*>(data_ + record.offset);
+}
+
+// Запросы читают записи без проверок, поэтому каждый номер и смещение в
+// секциях проверяется один раз при загрузке: имена лежат в STRINGS,
+// остановки автобусов — в BUS_STOPS, смещения не убывают, номера остановок,
+// автобусов и вершин меньше их числа, веса дуг неотрицательны
+bool CatalogueImage::HasValidIndices() const {
+    const uint64_t stop_count = header_->stop_count;
+    const uint64_t bus_count = header_->bus_count;
+    const uint64_t vertex_count = header_->vertex_count;
+    const uint64_t strings_size = header_->sections[STRINGS].size;
+    const uint64_t bus_stop_count = header_->sections[BUS_STOPS].size / sizeof(uint32_t);
+    const auto is_below = [](const auto* items, size_t count, uint64_t limit) {
+        return std::all_of(items, items + count, [limit](auto item) {
+            return static_cast<uint64_t>(item) < limit;
+        });
+    };
+    const auto is_offsets = [](const auto* offsets, size_t count) {
+        return offsets[0] == 0 && std::is_sorted(offsets, offsets + count);
+    };
+
+    for (size_t stop = 0; stop < stop_count; ++stop) {
+        if (uint64_t{stops_[stop].name_offset} + stops_[stop].name_size > strings_size) {
+            return false;
+        }
+    }
+    for (size_t bus = 0; bus < bus_count; ++bus) {
+        const BusRecord& record = buses_[bus];
+        if (uint64_t{record.name_offset} + record.name_size > strings_size
+            || uint64_t{record.first_stop} + record.stop_count > bus_stop_count) {
+            return false;
+        }
+    }
+    for (size_t index = 0; index < header_->distance_count; ++index) {
+        if (distances_[index].from >= stop_count || distances_[index].to >= stop_count) {
+            return false;
+        }
+    }
+    for (size_t stop = 0; stop < stop_count; ++stop) {
+        if (stop_vertices_[stop] != NO_IMAGE_VERTEX && stop_vertices_[stop] >= vertex_count) {
+            return false;
+        }
+    }
+    for (size_t arc = 0; arc < header_->arc_count; ++arc) {
+        if (!(arc_weights_[arc] >= 0.0) || arc_span_counts_[arc] < 0
+            || (arc_buses_[arc] != NO_IMAGE_BUS && arc_buses_[arc] >= bus_count)) {
+            return false;
+        }
+    }
+    return is_below(stop_name_index_, stop_count, stop_count) && is_below(bus_name_index_, bus_count, bus_count)
+        && is_below(bus_stops_, bus_stop_count, stop_count) && is_offsets(stop_bus_offsets_, stop_count + 1)
+        && is_below(stop_buses_, stop_bus_offsets_[stop_count], bus_count)
+        && is_below(vertex_stops_, vertex_count, stop_count) && is_offsets(arc_offsets_, vertex_count + 1)
+        && arc_offsets_[vertex_count] == header_->arc_count
+        && is_below(arc_targets_, header_->arc_count, vertex_count);
+}
+
+std::optional<Domain::StopId> CatalogueImage::FindStop(std::string_view name) const {
+    const uint32_t* end = stop_name_index_ + header_->stop_count;
+    const uint32_t* it = std::lower_bound(stop_name_index_, end, name, [this](uint32_t stop, std::string_view value) {
+        return GetStopName(stop) < value;
+    });
+    if (it == end || GetStopName(*it) != name) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::optional<Domain::BusId> CatalogueImage::FindBus(std::string_view name) const {
+    const uint32_t* end = bus_name_index_ + header_->bus_count;
+    const uint32_t* it = std::lower_bound(bus_name_index_, end, name, [this](uint32_t bus, std::string_view value) {
+        return GetBusName(bus) < value;
+    });
+    if (it == end || GetBusName(*it) != name) {
+        return std::nullopt;
+    }
+    return *it;
+}
+
+std::string_view CatalogueImage::GetStopName(Domain::StopId stop) const {
+    return {strings_ + stops_[stop].name_offset, stops_[stop].name_size};
+}
+
+std::string_view CatalogueImage::GetBusName(Domain::BusId bus) const {
+    return {strings_ + buses_[bus].name_offset, buses_[bus].name_size};
+}
+
+ranges::Range<const Domain::StopId*> CatalogueImage::GetBusStops(Domain::BusId bus) const {
+    const BusRecord& record = buses_[bus];
+    return {bus_stops_ + record.first_stop, bus_stops_ + record.first_stop + record.stop_count};
+}
+
+Domain::BusInfo CatalogueImage::GetBusInfo(Domain::BusId bus) const {
+    const BusRecord& record = buses_[bus];
+    return {record.stops_on_route, record.unique_stops, record.route_length, record.geo_length, record.curvature};
+}
+
+std::vector<std::string_view> CatalogueImage::GetBusNamesByStop(Domain::StopId stop) const {
+    std::vector<std::string_view> names;
+    names.reserve(stop_bus_offsets_[stop + 1] - stop_bus_offsets_[stop]);
+    for (uint32_t index = stop_bus_offsets_[stop]; index < stop_bus_offsets_[stop + 1]; ++index) {
+        names.push_back(GetBusName(stop_buses_[index]));
+    }
+    return names;
+}
+
+int CatalogueImage::GetDistance(Domain::StopId from, Domain::StopId to) const {
+    const DistanceRecord* end = distances_ + header_->distance_count;
+    auto find = [this, end](Domain::StopId lhs, Domain::StopId rhs) -> std::optional<int> {
+        const DistanceRecord* it = std::lower_bound(distances_, end, std::pair{lhs, rhs},
+            [](const DistanceRecord& record, const std::pair<Domain::StopId, Domain::StopId>& key) {
+                return std::tie(record.from, record.to) < std::tie(key.first, key.second);
+            });
+        if (it == end || it->from != lhs || it->to != rhs) {
+            return std::nullopt;
+        }
+        return it->distance;
+    };
+    if (const auto distance = find(from, to)) {
+        return *distance;
+    }
+    return find(to, from).value_or(0);
+}
+
+std::string_view CatalogueImage::GetMap() const {
+    return {map_, header_->sections[MAP].size};
+}
+
+// Вершина остановки из запроса, как TransportRouter::FindKnownStop
+uint32_t CatalogueImage::FindKnownVertex(std::string_view stop_name) const {
+    const auto stop = FindStop(stop_name);
+    if (!stop || stop_vertices_[*stop] == NO_IMAGE_VERTEX) {
+        throw std::out_of_range("Unknown stop");
+    }
+    return stop_vertices_[*stop];
+}
+
+// Подряд идущие дуги поездки складываются в один элемент BUS, как в
+// TransportRouter::ConvertRouteToRouteInfo; рёбра маршрута — номера дуг
+TransportRouter::RouteInfo CatalogueImage::ConvertRoute(graph::VertexId from,
+                                                        const graph::DijkstraRouter<double>::RouteInfo& route) const {
+    using RouteItem = TransportRouter::RouteItem;
+    TransportRouter::RouteInfo result{route.weight, {}};
+    bool riding = false;
+    graph::VertexId vertex = from;
+    for (const graph::EdgeId arc : route.edges) {
+        const double weight = arc_weights_[arc];
+        if (arc_buses_[arc] == NO_IMAGE_BUS) {
+            result.items.push_back({RouteItem::Type::WAIT, GetStopName(vertex_stops_[vertex]), weight, 0});
+            riding = false;
+        } else if (arc_span_counts_[arc] == 0) {
+            riding = false;
+        } else if (riding) {
+            result.items.back().time += weight;
+            result.items.back().span_count += arc_span_counts_[arc];
+        } else {
+            result.items.push_back({RouteItem::Type::BUS, GetBusName(arc_buses_[arc]), weight, arc_span_counts_[arc]});
+            riding = true;
+        }
+        vertex = arc_targets_[arc];
+    }
+    return result;
+}
+
+std::vector<std::optional<TransportRouter::RouteInfo>> CatalogueImage::BuildRoutes(
+    const std::vector<std::pair<std::string_view, std::string_view>>& requests) const {
+    std::vector<uint32_t> origins;
+    std::unordered_map<uint32_t, std::vector<size_t>> origin_to_requests;
+    std::vector<uint32_t> destinations(requests.size());
+    for (size_t index = 0; index < requests.size(); ++index) {
+        const uint32_t from = FindKnownVertex(requests[index].first);
+        destinations[index] = FindKnownVertex(requests[index].second);
+        auto& group = origin_to_requests[from];
+        if (group.empty()) {
+            origins.push_back(from);
+        }
+        group.push_back(index);
+    }
+
+    // Одиночный запрос останавливает поиск на цели, группа берёт маршруты
+    // из одного дерева
+    std::vector<std::optional<TransportRouter::RouteInfo>> results(requests.size());
+    for (const uint32_t from : origins) {
+        const auto& group = origin_to_requests.at(from);
+        if (group.size() == 1) {
+            if (const auto route = router_->BuildRoute(from, destinations[group.front()])) {
+                results[group.front()] = ConvertRoute(from, *route);
+            }
+            continue;
+        }
+        const auto tree = router_->BuildShortestPathTree(from);
+        for (const size_t index : group) {
+            if (const auto route = router_->BuildRoute(tree, destinations[index])) {
+                results[index] = ConvertRoute(from, *route);
+            }
+        }
+    }
+    return results;
+}
+
+std::vector<std::optional<double>> CatalogueImage::BuildTravelTimeMatrix(
+    const std::vector<std::string_view>& origins, const std::vector<std::string_view>& destinations) const {
+    std::vector<uint32_t> targets;
+    targets.reserve(destinations.size());
+    for (const auto to : destinations) {
+        targets.push_back(FindKnownVertex(to));
+    }
+    std::vector<std::optional<double>> times;
+    times.reserve(origins.size() * destinations.size());
+    for (const auto from : origins) {
+        const auto tree = router_->BuildShortestPathTree(FindKnownVertex(from));
+        for (const uint32_t to : targets) {
+            if (tree.IsReachable(to)) {
+                times.push_back(tree.weights[to]);
+            } else {
+                times.push_back(std::nullopt);
+            }
+        }
+    }
+    return times;
+}
+
+// Вершины позиций автобусов в компактной модели тоже ссылаются на
+// остановку, поэтому в ответ идут только вершины самих остановок
+std::vector<TransportRouter::ReachableStop> CatalogueImage::FindReachableStops(std::string_view from, double max_time) const {
+    std::vector<TransportRouter::ReachableStop> result;
+    for (const auto& [vertex, time] : router_->FindReachableVertices(FindKnownVertex(from), max_time)) {
+        const Domain::StopId stop = vertex_stops_[vertex];
+        if (stop_vertices_[stop] == vertex) {
+            result.push_back({GetStopName(stop), time});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const TransportRouter::ReachableStop& lhs,
+                                                const TransportRouter::ReachableStop& rhs) {
+        return std::tie(lhs.time, lhs.name) < std::tie(rhs.time, rhs.name);
+    });
+    return result;
+}
+
+} // namespace Transport
+} // namespace TransportCatalog
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "catalogue_snapshot.h"
+#include "csr_graph.h"
+#include "dijkstra_router.h"
+#include "domain.h"
+#include "ranges.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace TransportCatalog {
+namespace Transport {
+
+// Бинарный образ справочника и графа маршрутов. Файл состоит из заголовка
+// и секций с записями фиксированного размера, выровненных по 8 байт;
+// ссылки между записями — номера и смещения, а не указатели. Поэтому
+// CatalogueImage отвечает на запросы прямо из отображенного в память файла,
+// ничего не разбирая при загрузке, а процессы, открывшие один файл, делят
+// его страницы в кэше ОС. Порядок байт — машины, записавшей образ; при
+// несовпадении версии или порядка байт образ не открывается.
+//
+// В образе: остановки, автобусы с готовой информацией, списки автобусов по
+// остановкам, явно заданные расстояния, имена с индексами для поиска,
+// готовая SVG-карта и граф маршрутов в формате CSR. Массивы дуг лежат так
+// же, как в CsrGraph, и маршруты ищет graph::DijkstraRouter прямо по
+// отображённым страницам через CsrGraph::View. Все номера и смещения
+// проверяются при загрузке, испорченный файл не открывается.
+inline constexpr uint32_t CATALOGUE_IMAGE_VERSION = 2;
+
+class CatalogueImage {
+public:
+    // Отображает файл в память только для чтения; std::runtime_error, если
+    // файл не открывается или не является образом этой версии
+    explicit CatalogueImage(const std::string& path);
+    ~CatalogueImage();
+
+    CatalogueImage(const CatalogueImage&) = delete;
+    CatalogueImage& operator=(const CatalogueImage&) = delete;
+
+    // Записывает образ; router построен по тому же справочнику без сжатия цепочек
+    static void Write(const std::string& path, const CatalogueSnapshot& db, const TransportRouter& router,
+                      std::string_view map_svg);
+
+    std::optional<Domain::StopId> FindStop(std::string_view name) const;
+    std::optional<Domain::BusId> FindBus(std::string_view name) const;
+
+    std::string_view GetStopName(Domain::StopId stop) const;
+    std::string_view GetBusName(Domain::BusId bus) const;
+
+    ranges::Range<const Domain::StopId*> GetBusStops(Domain::BusId bus) const;
+
+    Domain::BusInfo GetBusInfo(Domain::BusId bus) const;
+
+    // Имена автобусов, проходящих через остановку, по алфавиту
+    std::vector<std::string_view> GetBusNamesByStop(Domain::StopId stop) const;
+
+    // Расстояние между остановками или обратное, если прямое не задано
+    int GetDistance(Domain::StopId from, Domain::StopId to) const;
+
+    std::string_view GetMap() const;
+
+    // Как у TransportRouter: один поиск на каждую различную остановку
+    // отправления, ответы в порядке запросов; имена в ответах ссылаются на образ
+    std::vector<std::optional<TransportRouter::RouteInfo>> BuildRoutes(
+        const std::vector<std::pair<std::string_view, std::string_view>>& requests) const;
+
+    std::vector<std::optional<double>> BuildTravelTimeMatrix(
+        const std::vector<std::string_view>& origins, const std::vector<std::string_view>& destinations) const;
+
+    std::vector<TransportRouter::ReachableStop> FindReachableStops(std::string_view from, double max_time) const;
+
+private:
+    struct Header;
+    struct StopRecord;
+    struct BusRecord;
+    struct DistanceRecord;
+
+    template <typename Record>
+    const Record* GetSection(size_t section, size_t count) const;
+
+    bool HasValidIndices() const;
+    uint32_t FindKnownVertex(std::string_view stop_name) const;
+    TransportRouter::RouteInfo ConvertRoute(graph::VertexId from,
+                                            const graph::DijkstraRouter<double>::RouteInfo& route) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+    const Header* header_ = nullptr;
+    const char* strings_ = nullptr;
+    const StopRecord* stops_ = nullptr;
+    const uint32_t* stop_name_index_ = nullptr;  // номера остановок по алфавиту имен
+    const BusRecord* buses_ = nullptr;
+    const uint32_t* bus_name_index_ = nullptr;
+    const uint32_t* bus_stops_ = nullptr;
+    const uint32_t* stop_bus_offsets_ = nullptr;
+    const uint32_t* stop_buses_ = nullptr;
+    const DistanceRecord* distances_ = nullptr;  // по возрастанию (from, to)
+    const char* map_ = nullptr;
+    const uint32_t* vertex_stops_ = nullptr;
+    const uint32_t* stop_vertices_ = nullptr;
+    // Дуги в формате CsrGraph; номер дуги служит номером ребра графа образа
+    const size_t* arc_offsets_ = nullptr;
+    const graph::VertexId* arc_targets_ = nullptr;
+    const double* arc_weights_ = nullptr;
+    const uint32_t* arc_buses_ = nullptr;
+    const int32_t* arc_span_counts_ = nullptr;
+
+    std::unique_ptr<graph::DijkstraRouter<double>> router_;
+};
+
+} // namespace Transport
+} // namespace TransportCatalog
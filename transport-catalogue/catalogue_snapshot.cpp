@@ -0,0 +1,105 @@
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+
+#include <algorithm>
+
+namespace TransportCatalog {
+namespace Transport {
+
+CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& db)
+    : stops_(db.GetAllStops().begin(), db.GetAllStops().end())
+    , buses_(db.GetAllBuses().begin(), db.GetAllBuses().end())
+    , distances_(db.GetDistanceTable()) {
+    // Векторы больше не растут, так что ссылки на имена в них устойчивы
+    stopname_to_id_.reserve(stops_.size());
+    for (const Domain::Stop& stop : stops_) {
+        stopname_to_id_.emplace(stop.name, stop.id);
+    }
+    busname_to_id_.reserve(buses_.size());
+    bus_infos_.reserve(buses_.size());
+    for (const Domain::Bus& bus : buses_) {
+        busname_to_id_.emplace(bus.name, bus.id);
+        bus_infos_.push_back(db.GetBusInfo(bus.name));
+    }
+
+    stop_bus_offsets_.reserve(stops_.size() + 1);
+    stop_bus_offsets_.push_back(0);
+    for (const Domain::Stop& stop : stops_) {
+        const auto begin = stop_bus_names_.size();
+        for (const Domain::BusId bus : db.GetBusIdsByStop(stop.id)) {
+            stop_bus_names_.push_back(buses_[bus].name);
+            stop_bus_ids_.push_back(bus);
+        }
+        std::sort(stop_bus_names_.begin() + begin, stop_bus_names_.end());
+        stop_bus_offsets_.push_back(stop_bus_names_.size());
+    }
+}
+
+const Domain::Stop* CatalogueSnapshot::FindStop(std::string_view name) const {
+    if (auto it = stopname_to_id_.find(name); it != stopname_to_id_.end()) {
+        return &stops_[it->second];
+    }
+    return nullptr;
+}
+
+const Domain::Stop& CatalogueSnapshot::GetStop(Domain::StopId id) const {
+    return stops_.at(id);
+}
+
+const Domain::Bus* CatalogueSnapshot::FindBus(std::string_view name) const {
+    if (auto it = busname_to_id_.find(name); it != busname_to_id_.end()) {
+        return &buses_[it->second];
+    }
+    return nullptr;
+}
+
+const Domain::Bus& CatalogueSnapshot::GetBus(Domain::BusId id) const {
+    return buses_.at(id);
+}
+
+const Domain::BusInfo& CatalogueSnapshot::GetBusInfo(Domain::BusId id) const {
+    return bus_infos_.at(id);
+}
+
+CatalogueSnapshot::BusNames CatalogueSnapshot::GetBusNamesByStop(Domain::StopId stop) const {
+    return {stop_bus_names_.begin() + stop_bus_offsets_.at(stop), stop_bus_names_.begin() + stop_bus_offsets_.at(stop + 1)};
+}
+
+CatalogueSnapshot::BusIds CatalogueSnapshot::GetBusIdsByStop(Domain::StopId stop) const {
+    return {stop_bus_ids_.begin() + stop_bus_offsets_.at(stop), stop_bus_ids_.begin() + stop_bus_offsets_.at(stop + 1)};
+}
+
+int CatalogueSnapshot::GetDistance(Domain::StopId from, Domain::StopId to) const {
+    return distances_.Get(from, to);
+}
+
+const std::vector<Domain::Stop>& CatalogueSnapshot::GetAllStops() const {
+    return stops_;
+}
+
+const std::vector<Domain::Bus>& CatalogueSnapshot::GetAllBuses() const {
+    return buses_;
+}
+
+const DistanceTable& CatalogueSnapshot::GetDistanceTable() const {
+    return distances_;
+}
+
+void SnapshotPublisher::Publish(std::shared_ptr<const CatalogueSnapshot> snapshot) {
+#ifdef __cpp_lib_atomic_shared_ptr
+    current_.store(std::move(snapshot));
+#else
+    std::atomic_store(&current_, std::move(snapshot));
+#endif
+}
+
+std::shared_ptr<const CatalogueSnapshot> SnapshotPublisher::Acquire() const {
+#ifdef __cpp_lib_atomic_shared_ptr
+    return current_.load();
+#else
+    return std::atomic_load(&current_);
+#endif
+}
+
+} // namespace Transport
+} // namespace TransportCatalog
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "domain.h"
+#include "distance_table.h"
+#include "ranges.h"
+
+#include <atomic>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace TransportCatalog {
+namespace Transport {
+
+class TransportCatalogue;
+
+// Неизменяемая копия справочника, снятая TransportCatalogue::Freeze.
+// Остановки и автобусы лежат подряд в векторах, списки автобусов по
+// остановкам — в одном общем массиве, информация об автобусах посчитана
+// заранее. Менять снимок нечем, поэтому читать его можно из любого
+// числа потоков без блокировок. TransportRouter тоже читает справочник
+// только через снимок.
+class CatalogueSnapshot {
+public:
+    using BusNames = ranges::Range<std::vector<std::string_view>::const_iterator>;
+    using BusIds = ranges::Range<std::vector<Domain::BusId>::const_iterator>;
+
+    explicit CatalogueSnapshot(const TransportCatalogue& db);
+
+    // Имена в индексах ссылаются на строки внутри снимка
+    CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+    CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+    const Domain::Stop* FindStop(std::string_view name) const;
+    const Domain::Stop& GetStop(Domain::StopId id) const;
+
+    const Domain::Bus* FindBus(std::string_view name) const;
+    const Domain::Bus& GetBus(Domain::BusId id) const;
+
+    const Domain::BusInfo& GetBusInfo(Domain::BusId id) const;
+
+    // Имена автобусов, проходящих через остановку, по алфавиту
+    BusNames GetBusNamesByStop(Domain::StopId stop) const;
+    // Номера автобусов, проходящих через остановку, в порядке добавления
+    BusIds GetBusIdsByStop(Domain::StopId stop) const;
+
+    // Расстояние между остановками или обратное, если прямое не задано
+    int GetDistance(Domain::StopId from, Domain::StopId to) const;
+
+    // Номер элемента совпадает с его id
+    const std::vector<Domain::Stop>& GetAllStops() const;
+    const std::vector<Domain::Bus>& GetAllBuses() const;
+
+    const DistanceTable& GetDistanceTable() const;
+
+private:
+    std::vector<Domain::Stop> stops_;
+    std::unordered_map<std::string_view, Domain::StopId> stopname_to_id_;
+
+    std::vector<Domain::Bus> buses_;
+    std::unordered_map<std::string_view, Domain::BusId> busname_to_id_;
+    std::vector<Domain::BusInfo> bus_infos_;  // индексируется BusId
+
+    // Имена и номера автобусов остановки stop — [stop_bus_offsets_[stop], stop_bus_offsets_[stop + 1])
+    std::vector<size_t> stop_bus_offsets_;
+    std::vector<std::string_view> stop_bus_names_;
+    std::vector<Domain::BusId> stop_bus_ids_;
+
+    DistanceTable distances_;
+};
+
+// Текущий снимок для читающих потоков. Publish заменяет его атомарно;
+// запрос, уже взявший прежний снимок через Acquire, дорабатывает с ним,
+// и тот освобождается вместе с последней ссылкой.
+class SnapshotPublisher {
+public:
+    void Publish(std::shared_ptr<const CatalogueSnapshot> snapshot);
+
+    // nullptr, пока ничего не опубликовано
+    std::shared_ptr<const CatalogueSnapshot> Acquire() const;
+
+private:
+#ifdef __cpp_lib_atomic_shared_ptr
+    std::atomic<std::shared_ptr<const CatalogueSnapshot>> current_;
+#else
+    // До C++20 — через std::atomic_load и std::atomic_store
+    std::shared_ptr<const CatalogueSnapshot> current_;
+#endif
+};
+
+} // namespace Transport
+} // namespace TransportCatalog
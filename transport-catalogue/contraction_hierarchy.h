@@ -0,0 +1,797 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "parallel.h"
+#include "router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сжатия (contraction hierarchies). Вершины по очереди удаляются
+// из графа; если кратчайший путь между соседями удаляемой вершины проходит
+// через неё, добавляется ребро-сокращение. Запрос — двунаправленный поиск,
+// который из обоих концов поднимается только к вершинам с большим рангом.
+// Память линейна по числу рёбер и сокращений. Сокращения раскрываются
+// в исходные EdgeId, поэтому маршрут совпадает по формату с Router.
+//
+// Вершины сжимаются раундами: в каждом раунде выбирается независимое
+// множество вершин с локально минимальным приоритетом, и поиски свидетелей
+// для них выполняются параллельно.
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+
+    struct Stats {
+        size_t shortcut_count = 0;
+        size_t round_count = 0;
+        double preprocessing_seconds = 0.0;
+    };
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    // Сжимает граф с новыми весами рёбер заново, но в прежнем порядке
+    // вершин: пропускается только подсчёт приоритетов. Поиски свидетелей
+    // выполняются снова, так как набор нужных сокращений зависит от весов,
+    // поэтому это не настройка метрики над готовой топологией сокращений.
+    void Recontract(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, SearchStats* stats = nullptr) const;
+
+    // Вес кратчайшего пути без раскрытия сокращений
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to, SearchStats* stats = nullptr) const;
+
+    // Веса кратчайших путей из from во все вершины (PHAST): поиск вверх по
+    // иерархии из from, затем проход по вершинам от старших рангов к младшим
+    // по рёбрам вниз. Проход линеен по размеру иерархии и не зависит от числа
+    // нужных вершин, поэтому окупается, когда их много.
+    std::vector<std::optional<Weight>> GetRouteWeightsFrom(VertexId from, SearchStats* stats = nullptr) const;
+
+    const Stats& GetStats() const {
+        return stats_;
+    }
+
+private:
+    using ArcId = size_t;
+    static constexpr ArcId NO_ARC = static_cast<ArcId>(-1);
+    static constexpr Weight ZERO_WEIGHT{};
+    // Поиск свидетеля прекращается после стольких извлечённых вершин и не
+    // продолжает пути длиннее WITNESS_HOP_LIMIT рёбер; если свидетель
+    // не найден, сокращение добавляется (это безопасно)
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+    static constexpr uint8_t WITNESS_HOP_LIMIT = 5;
+
+    // Ребро иерархии: исходное ребро графа или сокращение из двух рёбер
+    struct Arc {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId edge_id;  // для сокращений не используется
+        ArcId first;     // NO_ARC у исходных рёбер
+        ArcId second;
+    };
+
+    // Ребро, инцидентное вершине, в графе ещё не сжатых вершин
+    struct Link {
+        VertexId other;
+        Weight weight;
+        ArcId arc;
+    };
+
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        ArcId first;
+        ArcId second;
+    };
+
+    // Ребро из вершины к соседу с большим рангом, запоминается при сжатии
+    struct UpwardLink {
+        VertexId vertex;
+        VertexId target;
+        Weight weight;
+        ArcId arc;
+    };
+
+    // Рёбра, ведущие вверх по иерархии, в формате CSR
+    struct UpwardGraph {
+        std::vector<size_t> offsets;
+        std::vector<VertexId> targets;
+        std::vector<Weight> weights;
+        std::vector<ArcId> arcs;
+    };
+
+    // Рабочие массивы одного направления поиска, переиспользуемые между
+    // поисками в потоке; см. DijkstraRouter::SearchState
+    struct SearchSpace {
+        using QueueEntry = std::pair<Weight, VertexId>;
+
+        std::vector<Weight> weights;
+        std::vector<ArcId> prev_arcs;
+        std::vector<uint32_t> generations;
+        std::vector<QueueEntry> queue;
+        uint32_t generation = 0;
+
+        void Reset(size_t vertex_count) {
+            if (generations.size() != vertex_count) {
+                weights.resize(vertex_count);
+                prev_arcs.resize(vertex_count);
+                generations.assign(vertex_count, 0);
+                generation = 0;
+            }
+            if (++generation == 0) {
+                std::fill(generations.begin(), generations.end(), 0);
+                generation = 1;
+            }
+            queue.clear();
+        }
+
+        bool IsReached(VertexId vertex) const {
+            return generations[vertex] == generation;
+        }
+
+        // Возвращает true, если вес вершины улучшился
+        bool Relax(VertexId vertex, Weight weight, ArcId prev_arc) {
+            if (IsReached(vertex) && !(weight < weights[vertex])) {
+                return false;
+            }
+            generations[vertex] = generation;
+            weights[vertex] = weight;
+            prev_arcs[vertex] = prev_arc;
+            queue.push_back({weight, vertex});
+            std::push_heap(queue.begin(), queue.end(), std::greater<QueueEntry>{});
+            return true;
+        }
+
+        // Извлекает вершину с минимальным весом, пропуская устаревшие записи
+        std::optional<VertexId> Pop() {
+            while (!queue.empty()) {
+                std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>{});
+                const auto [weight, vertex] = queue.back();
+                queue.pop_back();
+                if (!(weights[vertex] < weight)) {
+                    return vertex;
+                }
+            }
+            return std::nullopt;
+        }
+
+        std::optional<Weight> GetMinKey() const {
+            if (queue.empty()) {
+                return std::nullopt;
+            }
+            return queue.front().first;
+        }
+    };
+
+    // Цели поиска свидетелей с допустимым весом пути; отметки по поколениям,
+    // как в SearchSpace
+    struct WitnessTargets {
+        std::vector<Weight> limits;
+        std::vector<uint32_t> generations;
+        std::vector<bool> open;
+        std::vector<uint8_t> hops;  // число рёбер в найденном пути, по вершинам поиска
+        uint32_t generation = 0;
+
+        void Reset() {
+            if (++generation == 0) {
+                std::fill(generations.begin(), generations.end(), 0);
+                generation = 1;
+            }
+        }
+
+        void Mark(VertexId vertex, Weight limit) {
+            generations[vertex] = generation;
+            limits[vertex] = limit;
+            open[vertex] = true;
+        }
+
+        bool IsOpen(VertexId vertex) const {
+            return generations[vertex] == generation && open[vertex];
+        }
+
+        Weight GetLimit(VertexId vertex) const {
+            return limits[vertex];
+        }
+
+        void Close(VertexId vertex) {
+            open[vertex] = false;
+        }
+    };
+
+    static WitnessTargets& GetWitnessTargets(size_t vertex_count) {
+        thread_local WitnessTargets targets;
+        if (targets.generations.size() != vertex_count) {
+            targets.limits.resize(vertex_count);
+            targets.open.resize(vertex_count);
+            targets.hops.resize(vertex_count);
+            targets.generations.assign(vertex_count, 0);
+            targets.generation = 0;
+        }
+        return targets;
+    }
+
+    // Рабочие массивы потока: 0 — прямой поиск и поиск свидетелей, 1 — обратный
+    static SearchSpace& GetSearchSpaceState(size_t index) {
+        thread_local SearchSpace spaces[2];
+        return spaces[index];
+    }
+
+    static SearchSpace& GetSearchSpace(size_t index, size_t vertex_count) {
+        SearchSpace& space = GetSearchSpaceState(index);
+        space.Reset(vertex_count);
+        return space;
+    }
+
+    void InitializeLinks(const Graph& graph);
+    void Contract();
+    void ContractInOrder(const std::vector<std::vector<VertexId>>& rounds);
+    void ContractRound(const std::vector<VertexId>& selected);
+    void BuildUpwardGraphs();
+    std::vector<Shortcut> FindShortcuts(VertexId vertex) const;
+    int ComputePriority(VertexId vertex) const;
+    bool AddArc(const Arc& arc);
+    void ContractVertex(VertexId vertex, const std::vector<Shortcut>& shortcuts);
+    UpwardGraph BuildUpwardGraph(const std::vector<UpwardLink>& links) const;
+    void UnpackArc(ArcId arc, std::vector<EdgeId>& edges) const;
+
+    // Двунаправленный поиск; возвращает вес и вершину встречи, состояние
+    // поиска остаётся в рабочих массивах потока для восстановления пути
+    std::optional<std::pair<Weight, VertexId>> Search(VertexId from, VertexId to, SearchStats* stats) const;
+
+    size_t vertex_count_;
+    std::vector<Arc> arcs_;
+    // Вершины, сжатые в каждом раунде; ранг вершины — её место в этом
+    // порядке. Используется в Recontract.
+    std::vector<std::vector<VertexId>> rounds_;
+
+    // Состояние сжатия, освобождается после построения. Списки смежности
+    // содержат только ещё не сжатые вершины.
+    std::vector<std::vector<Link>> out_links_;
+    std::vector<std::vector<Link>> in_links_;
+    std::vector<int> contracted_neighbors_;
+    // Вершины текущего раунда; пути через них не считаются свидетелями
+    std::vector<bool> contracting_;
+    std::vector<UpwardLink> forward_links_;
+    std::vector<UpwardLink> backward_links_;
+
+    UpwardGraph forward_up_;   // рёбра u -> v с rank[v] > rank[u]
+    UpwardGraph backward_up_;  // для вершины v: рёбра u -> v с rank[u] > rank[v]
+    Stats stats_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : vertex_count_(graph.GetVertexCount())
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    InitializeLinks(graph);
+    Contract();
+    BuildUpwardGraphs();
+
+    stats_.preprocessing_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Recontract(const Graph& graph) {
+    if (graph.GetVertexCount() != vertex_count_) {
+        throw std::logic_error("Vertex count of the graph has changed");
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto rounds = std::move(rounds_);
+    rounds_.clear();
+    arcs_.clear();
+    stats_ = {};
+    InitializeLinks(graph);
+    ContractInOrder(rounds);
+    BuildUpwardGraphs();
+
+    stats_.preprocessing_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Переводит результат сжатия в CSR и освобождает рабочее состояние
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraphs() {
+    forward_up_ = BuildUpwardGraph(forward_links_);
+    backward_up_ = BuildUpwardGraph(backward_links_);
+
+    out_links_ = {};
+    in_links_ = {};
+    contracted_neighbors_ = {};
+    contracting_ = {};
+    forward_links_ = {};
+    backward_links_ = {};
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::InitializeLinks(const Graph& graph) {
+    out_links_.assign(vertex_count_, {});
+    in_links_.assign(vertex_count_, {});
+    contracted_neighbors_.assign(vertex_count_, 0);
+    contracting_.assign(vertex_count_, false);
+
+    arcs_.reserve(graph.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        // Петли не участвуют в кратчайших путях
+        if (edge.from == edge.to) {
+            continue;
+        }
+        AddArc({edge.from, edge.to, edge.weight, edge_id, NO_ARC, NO_ARC});
+    }
+}
+
+// Добавляет ребро, если между его концами ещё нет ребра не тяжелее;
+// параллельное ребро с большим весом заменяется
+template <typename Weight>
+bool ContractionHierarchy<Weight>::AddArc(const Arc& new_arc) {
+    auto& out = out_links_[new_arc.from];
+    const auto existing = std::find_if(out.begin(), out.end(), [&new_arc](const Link& link) {
+        return link.other == new_arc.to;
+    });
+    if (existing != out.end() && !(new_arc.weight < existing->weight)) {
+        return false;
+    }
+
+    const ArcId arc = arcs_.size();
+    arcs_.push_back(new_arc);
+    if (existing != out.end()) {
+        existing->weight = new_arc.weight;
+        existing->arc = arc;
+        auto& in = in_links_[new_arc.to];
+        const auto reverse = std::find_if(in.begin(), in.end(), [&new_arc](const Link& link) {
+            return link.other == new_arc.from;
+        });
+        reverse->weight = new_arc.weight;
+        reverse->arc = arc;
+    } else {
+        out.push_back({new_arc.to, new_arc.weight, arc});
+        in_links_[new_arc.to].push_back({new_arc.from, new_arc.weight, arc});
+    }
+    return true;
+}
+
+// Сокращения, которые нужно добавить при удалении vertex: для каждой пары
+// соседей u -> vertex -> w, между которыми нет пути-свидетеля не длиннее
+// пути через vertex
+template <typename Weight>
+std::vector<typename ContractionHierarchy<Weight>::Shortcut> ContractionHierarchy<Weight>::FindShortcuts(
+    VertexId vertex) const {
+    std::vector<Shortcut> shortcuts;
+    const auto& in = in_links_[vertex];
+    const auto& out = out_links_[vertex];
+    if (in.empty() || out.empty()) {
+        return shortcuts;
+    }
+
+    Weight max_out = ZERO_WEIGHT;
+    for (const Link& out_link : out) {
+        if (max_out < out_link.weight) {
+            max_out = out_link.weight;
+        }
+    }
+
+    SearchSpace& space = GetSearchSpace(0, vertex_count_);
+    WitnessTargets& targets = GetWitnessTargets(vertex_count_);
+    for (const Link& in_link : in) {
+        const VertexId source = in_link.other;
+
+        // Для каждой цели запоминаем вес пути через vertex; цель закрыта,
+        // как только найден путь в обход vertex не длиннее этого веса
+        targets.Reset();
+        Weight limit = ZERO_WEIGHT;
+        size_t targets_left = 0;
+        for (const Link& out_link : out) {
+            if (out_link.other != source) {
+                const Weight via_weight = in_link.weight + out_link.weight;
+                targets.Mark(out_link.other, via_weight);
+                limit = std::max(limit, via_weight);
+                ++targets_left;
+            }
+        }
+
+        // Поиск свидетелей от source без vertex; заканчивается, когда все
+        // цели закрыты или извлечённый вес превысил наибольший вес через vertex
+        space.Reset(vertex_count_);
+        space.Relax(source, ZERO_WEIGHT, NO_ARC);
+        targets.hops[source] = 0;
+        size_t settled = 0;
+        while (targets_left > 0) {
+            const auto current = space.Pop();
+            if (!current) {
+                break;
+            }
+            const Weight weight = space.weights[*current];
+            if (limit < weight || ++settled > WITNESS_SETTLE_LIMIT) {
+                break;
+            }
+            const uint8_t hops = targets.hops[*current];
+            if (hops >= WITNESS_HOP_LIMIT) {
+                continue;
+            }
+            for (const Link& link : out_links_[*current]) {
+                if (link.other == vertex || contracting_[link.other]
+                    || !space.Relax(link.other, weight + link.weight, link.arc)) {
+                    continue;
+                }
+                targets.hops[link.other] = hops + 1;
+                if (targets.IsOpen(link.other) && !(targets.GetLimit(link.other) < space.weights[link.other])) {
+                    targets.Close(link.other);
+                    --targets_left;
+                }
+            }
+        }
+
+        for (const Link& out_link : out) {
+            if (targets.IsOpen(out_link.other)) {
+                shortcuts.push_back({source, out_link.other, targets.GetLimit(out_link.other), in_link.arc, out_link.arc});
+            }
+        }
+    }
+    return shortcuts;
+}
+
+// Приоритет — разность числа добавляемых и удаляемых рёбер плюс число уже
+// сжатых соседей, чтобы сжатие шло по графу равномерно
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(VertexId vertex) const {
+    const int removed = static_cast<int>(in_links_[vertex].size() + out_links_[vertex].size());
+    return static_cast<int>(FindShortcuts(vertex).size()) - removed + contracted_neighbors_[vertex];
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    std::vector<VertexId> remaining(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        remaining[vertex] = vertex;
+    }
+    std::vector<int> priorities(vertex_count_, 0);
+    std::vector<bool> dirty(vertex_count_, true);
+
+    while (!remaining.empty()) {
+        ++stats_.round_count;
+
+        // Пересчитываем приоритеты вершин, чьё окружение изменилось
+        std::vector<VertexId> to_update;
+        for (const VertexId vertex : remaining) {
+            if (dirty[vertex]) {
+                to_update.push_back(vertex);
+                dirty[vertex] = false;
+            }
+        }
+        parallel::ForEachIndex(to_update.size(), [&](size_t index) {
+            priorities[to_update[index]] = ComputePriority(to_update[index]);
+        });
+
+        // Независимое множество: вершины с приоритетом меньше, чем у всех несжатых соседей
+        auto precedes = [&priorities](VertexId lhs, VertexId rhs) {
+            return std::pair{priorities[lhs], lhs} < std::pair{priorities[rhs], rhs};
+        };
+        std::vector<VertexId> selected;
+        std::vector<VertexId> rest;
+        for (const VertexId vertex : remaining) {
+            auto is_local_minimum = [&](const std::vector<Link>& links) {
+                return std::all_of(links.begin(), links.end(), [&](const Link& link) {
+                    return precedes(vertex, link.other);
+                });
+            };
+            if (is_local_minimum(in_links_[vertex]) && is_local_minimum(out_links_[vertex])) {
+                selected.push_back(vertex);
+            } else {
+                rest.push_back(vertex);
+            }
+        }
+
+        for (const VertexId vertex : selected) {
+            for (const auto* links : {&in_links_[vertex], &out_links_[vertex]}) {
+                for (const Link& link : *links) {
+                    dirty[link.other] = true;
+                }
+            }
+        }
+        ContractRound(selected);
+        remaining = std::move(rest);
+    }
+}
+
+// Сжатие в порядке раундов прежнего построения. При других весах набор
+// сокращений другой, и вершины одного раунда могут оказаться соседями —
+// такие переносятся в следующий раунд.
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractInOrder(const std::vector<std::vector<VertexId>>& rounds) {
+    std::vector<bool> blocked(vertex_count_, false);
+    std::vector<VertexId> pending;
+    for (size_t next_round = 0; next_round < rounds.size() || !pending.empty();) {
+        ++stats_.round_count;
+        std::vector<VertexId> candidates = std::move(pending);
+        pending.clear();
+        if (next_round < rounds.size()) {
+            candidates.insert(candidates.end(), rounds[next_round].begin(), rounds[next_round].end());
+            ++next_round;
+        }
+
+        std::vector<VertexId> selected;
+        for (const VertexId vertex : candidates) {
+            if (blocked[vertex]) {
+                pending.push_back(vertex);
+                continue;
+            }
+            selected.push_back(vertex);
+            for (const auto* links : {&in_links_[vertex], &out_links_[vertex]}) {
+                for (const Link& link : *links) {
+                    blocked[link.other] = true;
+                }
+            }
+        }
+        for (const VertexId vertex : selected) {
+            for (const auto* links : {&in_links_[vertex], &out_links_[vertex]}) {
+                for (const Link& link : *links) {
+                    blocked[link.other] = false;
+                }
+            }
+        }
+        ContractRound(selected);
+    }
+}
+
+// Сжимает независимое множество вершин: сокращения ищутся параллельно,
+// затем вершины удаляются по очереди
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractRound(const std::vector<VertexId>& selected) {
+    // Свидетель для одной вершины раунда мог бы пройти через другую,
+    // которая сжимается одновременно, поэтому такие пути исключаются
+    for (const VertexId vertex : selected) {
+        contracting_[vertex] = true;
+    }
+    std::vector<std::vector<Shortcut>> shortcuts(selected.size());
+    parallel::ForEachIndex(selected.size(), [&](size_t index) {
+        shortcuts[index] = FindShortcuts(selected[index]);
+    });
+    for (const VertexId vertex : selected) {
+        contracting_[vertex] = false;
+    }
+
+    for (size_t index = 0; index < selected.size(); ++index) {
+        const VertexId vertex = selected[index];
+        for (const auto* links : {&in_links_[vertex], &out_links_[vertex]}) {
+            for (const Link& link : *links) {
+                ++contracted_neighbors_[link.other];
+            }
+        }
+        ContractVertex(vertex, shortcuts[index]);
+    }
+    rounds_.push_back(selected);
+}
+
+// Все оставшиеся соседи вершины получат больший ранг: её рёбра становятся
+// рёбрами вверх по иерархии и удаляются из списков смежности соседей
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractVertex(VertexId vertex, const std::vector<Shortcut>& shortcuts) {
+    auto erase_links_to = [vertex](std::vector<Link>& links) {
+        links.erase(std::remove_if(links.begin(), links.end(), [vertex](const Link& link) {
+            return link.other == vertex;
+        }), links.end());
+    };
+    for (const Link& link : out_links_[vertex]) {
+        forward_links_.push_back({vertex, link.other, link.weight, link.arc});
+        erase_links_to(in_links_[link.other]);
+    }
+    for (const Link& link : in_links_[vertex]) {
+        backward_links_.push_back({vertex, link.other, link.weight, link.arc});
+        erase_links_to(out_links_[link.other]);
+    }
+    out_links_[vertex] = {};
+    in_links_[vertex] = {};
+
+    for (const Shortcut& shortcut : shortcuts) {
+        if (AddArc({shortcut.from, shortcut.to, shortcut.weight, 0, shortcut.first, shortcut.second})) {
+            ++stats_.shortcut_count;
+        }
+    }
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::UpwardGraph ContractionHierarchy<Weight>::BuildUpwardGraph(
+    const std::vector<UpwardLink>& links) const {
+    UpwardGraph result;
+    result.offsets.assign(vertex_count_ + 1, 0);
+    for (const UpwardLink& link : links) {
+        ++result.offsets[link.vertex + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        result.offsets[vertex + 1] += result.offsets[vertex];
+    }
+    result.targets.resize(links.size());
+    result.weights.resize(links.size());
+    result.arcs.resize(links.size());
+    std::vector<size_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+    for (const UpwardLink& link : links) {
+        const size_t position = positions[link.vertex]++;
+        result.targets[position] = link.target;
+        result.weights[position] = link.weight;
+        result.arcs[position] = link.arc;
+    }
+    return result;
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackArc(ArcId arc, std::vector<EdgeId>& edges) const {
+    std::vector<ArcId> stack{arc};
+    while (!stack.empty()) {
+        const Arc& current = arcs_[stack.back()];
+        stack.pop_back();
+        if (current.first == NO_ARC) {
+            edges.push_back(current.edge_id);
+        } else {
+            stack.push_back(current.second);
+            stack.push_back(current.first);
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<std::pair<Weight, VertexId>> ContractionHierarchy<Weight>::Search(
+    VertexId from, VertexId to, SearchStats* stats) const {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchSpace* spaces[2] = {&GetSearchSpace(0, vertex_count_), &GetSearchSpace(1, vertex_count_)};
+    const UpwardGraph* graphs[2] = {&forward_up_, &backward_up_};
+    spaces[0]->Relax(from, ZERO_WEIGHT, NO_ARC);
+    spaces[1]->Relax(to, ZERO_WEIGHT, NO_ARC);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    size_t settled = 0;
+    for (size_t side = 0;; side ^= 1) {
+        // Направление больше не может улучшить ответ, если его минимальный
+        // ключ не меньше лучшего найденного веса
+        auto is_active = [&](size_t index) {
+            const auto min_key = spaces[index]->GetMinKey();
+            return min_key && (!best_weight || *min_key < *best_weight);
+        };
+        if (!is_active(0) && !is_active(1)) {
+            break;
+        }
+        if (!is_active(side)) {
+            continue;
+        }
+
+        SearchSpace& space = *spaces[side];
+        const SearchSpace& other = *spaces[side ^ 1];
+        const auto vertex = space.Pop();
+        if (!vertex) {
+            continue;
+        }
+        ++settled;
+        const Weight weight = space.weights[*vertex];
+        if (other.IsReached(*vertex)) {
+            const Weight total = weight + other.weights[*vertex];
+            if (!best_weight || total < *best_weight) {
+                best_weight = total;
+                meeting_vertex = *vertex;
+            }
+        }
+        const UpwardGraph& graph = *graphs[side];
+        for (size_t position = graph.offsets[*vertex]; position < graph.offsets[*vertex + 1]; ++position) {
+            space.Relax(graph.targets[position], weight + graph.weights[position], graph.arcs[position]);
+        }
+    }
+    if (stats) {
+        stats->settled_vertices += settled;
+    }
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    return std::pair{*best_weight, meeting_vertex};
+}
+
+template <typename Weight>
+std::optional<Weight> ContractionHierarchy<Weight>::GetRouteWeight(
+    VertexId from, VertexId to, SearchStats* stats) const {
+    if (const auto result = Search(from, to, stats)) {
+        return result->first;
+    }
+    return std::nullopt;
+}
+
+template <typename Weight>
+std::vector<std::optional<Weight>> ContractionHierarchy<Weight>::GetRouteWeightsFrom(
+    VertexId from, SearchStats* stats) const {
+    if (from >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    SearchSpace& space = GetSearchSpace(0, vertex_count_);
+    space.Relax(from, ZERO_WEIGHT, NO_ARC);
+    size_t settled = 0;
+    while (const auto vertex = space.Pop()) {
+        ++settled;
+        const Weight weight = space.weights[*vertex];
+        for (size_t position = forward_up_.offsets[*vertex]; position < forward_up_.offsets[*vertex + 1];
+             ++position) {
+            space.Relax(forward_up_.targets[position], weight + forward_up_.weights[position],
+                        forward_up_.arcs[position]);
+        }
+    }
+    if (stats) {
+        stats->settled_vertices += settled;
+    }
+
+    std::vector<std::optional<Weight>> weights(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        if (space.IsReached(vertex)) {
+            weights[vertex] = space.weights[vertex];
+        }
+    }
+    // Вершины одного раунда не связаны рёбрами, поэтому к моменту обработки
+    // вершины веса всех старших соседей уже окончательны
+    for (auto round = rounds_.rbegin(); round != rounds_.rend(); ++round) {
+        for (const VertexId vertex : *round) {
+            for (size_t position = backward_up_.offsets[vertex]; position < backward_up_.offsets[vertex + 1];
+                 ++position) {
+                const auto& upper_weight = weights[backward_up_.targets[position]];
+                if (!upper_weight) {
+                    continue;
+                }
+                const Weight weight = *upper_weight + backward_up_.weights[position];
+                if (!weights[vertex] || weight < *weights[vertex]) {
+                    weights[vertex] = weight;
+                }
+            }
+        }
+    }
+    return weights;
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(
+    VertexId from, VertexId to, SearchStats* stats) const {
+    const auto result = Search(from, to, stats);
+    if (!result) {
+        return std::nullopt;
+    }
+    const auto [weight, meeting_vertex] = *result;
+    const SearchSpace& forward = GetSearchSpaceState(0);
+    const SearchSpace& backward = GetSearchSpaceState(1);
+
+    // Прямая половина восстанавливается от точки встречи к началу
+    std::vector<ArcId> forward_arcs;
+    for (VertexId vertex = meeting_vertex; forward.prev_arcs[vertex] != NO_ARC;) {
+        const ArcId arc = forward.prev_arcs[vertex];
+        forward_arcs.push_back(arc);
+        vertex = arcs_[arc].from;
+    }
+    std::vector<EdgeId> edges;
+    for (auto it = forward_arcs.rbegin(); it != forward_arcs.rend(); ++it) {
+        UnpackArc(*it, edges);
+    }
+    for (VertexId vertex = meeting_vertex; backward.prev_arcs[vertex] != NO_ARC;) {
+        const ArcId arc = backward.prev_arcs[vertex];
+        UnpackArc(arc, edges);
+        vertex = arcs_[arc].to;
+    }
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
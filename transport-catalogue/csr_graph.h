@@ -0,0 +1,174 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Какие рёбра вершины хранит CsrGraph: исходящие или входящие
+enum class CsrDirection {
+    OUTGOING,
+    INCOMING,
+};
+
+// Неизменяемое представление графа в формате CSR (compressed sparse row).
+// Рёбра, исходящие из вершины v, лежат подряд в позициях
+// [GetArcsBegin(v), GetArcsEnd(v)) отдельных массивов целей, весов и
+// идентификаторов исходных рёбер, поэтому обход соседей идёт по памяти
+// последовательно и без проверок границ. В режиме INCOMING хранятся
+// входящие рёбра, а целью дуги считается начало исходного ребра — это
+// обращённый граф для поиска «к вершине».
+//
+// Граф может и не владеть массивами: View смотрит на готовые массивы,
+// например в отображённом в память файле. У такого графа нет исходного
+// DirectedWeightedGraph, идентификатор ребра дуги — её номер, а веса не
+// меняются. Массивы владеющего графа не переезжают при его перемещении,
+// поэтому копирование запрещено, а перемещение разрешено.
+template <typename Weight>
+class CsrGraph {
+public:
+    CsrGraph() = default;
+    explicit CsrGraph(const DirectedWeightedGraph<Weight>& graph,
+                      CsrDirection direction = CsrDirection::OUTGOING);
+    // Веса дуг получаются из весов исходного графа функцией convert, так
+    // что граф с другим типом весов не нужно копировать целиком
+    template <typename GraphWeight, typename Convert>
+    CsrGraph(const DirectedWeightedGraph<GraphWeight>& graph, CsrDirection direction, Convert convert);
+
+    CsrGraph(const CsrGraph&) = delete;
+    CsrGraph& operator=(const CsrGraph&) = delete;
+    CsrGraph(CsrGraph&&) = default;
+    CsrGraph& operator=(CsrGraph&&) = default;
+
+    // Граф без копирования поверх массивов в формате CSR: offsets длиной
+    // vertex_count + 1, targets и weights длиной offsets[vertex_count].
+    // Массивы должны жить дольше графа.
+    static CsrGraph View(size_t vertex_count, const size_t* offsets, const VertexId* targets, const Weight* weights);
+
+    size_t GetVertexCount() const {
+        return vertex_count_;
+    }
+    size_t GetEdgeCount() const {
+        return vertex_count_ == 0 ? 0 : offsets_[vertex_count_];
+    }
+
+    size_t GetArcsBegin(VertexId vertex) const {
+        return offsets_[vertex];
+    }
+    size_t GetArcsEnd(VertexId vertex) const {
+        return offsets_[vertex + 1];
+    }
+
+    VertexId GetTarget(size_t arc) const {
+        return targets_[arc];
+    }
+    Weight GetWeight(size_t arc) const {
+        return weights_[arc];
+    }
+    // Идентификатор ребра в исходном DirectedWeightedGraph, у View — номер дуги
+    EdgeId GetEdgeId(size_t arc) const {
+        return edge_ids_ ? edge_ids_[arc] : arc;
+    }
+
+    // Вершина, в списке дуг которой лежит дуга arc: начало ребра для
+    // OUTGOING, конец — для INCOMING
+    VertexId GetArcOwner(size_t arc) const;
+
+    bool IsView() const {
+        return vertex_count_ != 0 && offsets_ != owned_offsets_.data();
+    }
+
+    // Перечитывает веса дуг из исходного графа с прежним набором рёбер
+    void UpdateWeights(const DirectedWeightedGraph<Weight>& graph) {
+        UpdateWeights(graph, [](Weight weight) {
+            return weight;
+        });
+    }
+    template <typename GraphWeight, typename Convert>
+    void UpdateWeights(const DirectedWeightedGraph<GraphWeight>& graph, Convert convert) {
+        if (IsView()) {
+            throw std::logic_error("Weights of a CSR view cannot be updated");
+        }
+        for (size_t arc = 0; arc < owned_edge_ids_.size(); ++arc) {
+            owned_weights_[arc] = convert(graph.GetEdge(owned_edge_ids_[arc]).weight);
+        }
+    }
+
+private:
+    std::vector<size_t> owned_offsets_;
+    std::vector<VertexId> owned_targets_;
+    std::vector<Weight> owned_weights_;
+    std::vector<EdgeId> owned_edge_ids_;
+
+    // Массивы, по которым идёт обход: свои или чужие у View
+    size_t vertex_count_ = 0;
+    const size_t* offsets_ = nullptr;
+    const VertexId* targets_ = nullptr;
+    const Weight* weights_ = nullptr;
+    const EdgeId* edge_ids_ = nullptr;
+};
+
+template <typename Weight>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<Weight>& graph, CsrDirection direction)
+    : CsrGraph(graph, direction, [](Weight weight) {
+        return weight;
+    })
+{
+}
+
+template <typename Weight>
+template <typename GraphWeight, typename Convert>
+CsrGraph<Weight>::CsrGraph(const DirectedWeightedGraph<GraphWeight>& graph, CsrDirection direction, Convert convert)
+    : owned_offsets_(graph.GetVertexCount() + 1, 0)
+    , owned_targets_(graph.GetEdgeCount())
+    , owned_weights_(graph.GetEdgeCount())
+    , owned_edge_ids_(graph.GetEdgeCount())
+    , vertex_count_(graph.GetVertexCount())
+    , offsets_(owned_offsets_.data())
+    , targets_(owned_targets_.data())
+    , weights_(owned_weights_.data())
+    , edge_ids_(owned_edge_ids_.data())
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    const bool outgoing = direction == CsrDirection::OUTGOING;
+
+    // Дуги вершины берутся из её списка инцидентности (для INCOMING — из
+    // списка входящих рёбер) в порядке добавления рёбер
+    size_t arc = 0;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const auto edges = outgoing ? graph.GetIncidentEdges(vertex) : graph.GetIncomingEdges(vertex);
+        for (const EdgeId edge_id : edges) {
+            const auto& edge = graph.GetEdge(edge_id);
+            owned_targets_[arc] = outgoing ? edge.to : edge.from;
+            owned_weights_[arc] = convert(edge.weight);
+            owned_edge_ids_[arc] = edge_id;
+            ++arc;
+        }
+        owned_offsets_[vertex + 1] = arc;
+    }
+}
+
+template <typename Weight>
+CsrGraph<Weight> CsrGraph<Weight>::View(size_t vertex_count, const size_t* offsets, const VertexId* targets,
+                                        const Weight* weights) {
+    CsrGraph csr;
+    csr.vertex_count_ = vertex_count;
+    csr.offsets_ = offsets;
+    csr.targets_ = targets;
+    csr.weights_ = weights;
+    return csr;
+}
+
+// Первая вершина, чьи дуги кончаются после arc; у вершин без дуг начало
+// и конец совпадают, и они пропускаются
+template <typename Weight>
+VertexId CsrGraph<Weight>::GetArcOwner(size_t arc) const {
+    const size_t* end = std::upper_bound(offsets_ + 1, offsets_ + vertex_count_ + 1, arc);
+    return static_cast<VertexId>(end - offsets_ - 1);
+}
+
+}  // namespace graph
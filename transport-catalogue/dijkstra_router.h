@@ -0,0 +1,487 @@
+#pragma once
+
+#include "csr_graph.h"
+#include "graph.h"
+#include "radix_heap.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дерево кратчайших путей от одной вершины: вес пути и последнее ребро пути
+// для каждой вершины графа
+template <typename Weight>
+struct ShortestPathTree {
+    static constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+
+    VertexId root = 0;
+    // Остальные вершины-источники дерева поиска из нескольких вершин, по возрастанию
+    std::vector<VertexId> other_roots;
+    std::vector<Weight> weights;
+    std::vector<EdgeId> prev_edges;
+
+    bool IsRoot(VertexId vertex) const {
+        return vertex == root || std::binary_search(other_roots.begin(), other_roots.end(), vertex);
+    }
+
+    bool IsReachable(VertexId vertex) const {
+        return prev_edges[vertex] != NO_EDGE || IsRoot(vertex);
+    }
+
+    size_t GetMemoryUsage() const {
+        return sizeof(*this) + other_roots.capacity() * sizeof(VertexId) + weights.capacity() * sizeof(Weight)
+            + prev_edges.capacity() * sizeof(EdgeId);
+    }
+
+    // Остаётся ли дерево прямого поиска точным после изменения весов рёбер графа:
+    // ни одно ребро дерева не изменило вес и ни одно подешевевшее ребро не сокращает путь до своего конца
+    bool IsValidAfter(const DirectedWeightedGraph<Weight>& graph,
+                      const std::vector<EdgeWeightChange<Weight>>& changes) const {
+        for (const auto& [edge_id, old_weight] : changes) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (prev_edges[edge.to] == edge_id) {
+                return false;
+            }
+            if (edge.weight < old_weight && IsReachable(edge.from)
+                && (!IsReachable(edge.to) || weights[edge.from] + edge.weight < weights[edge.to])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Счётчики одного поиска
+struct SearchStats {
+    size_t settled_vertices = 0;  // вершин извлечено из очереди
+};
+
+// Маршрутизатор без предварительного расчёта: каждый запрос BuildRoute
+// выполняет поиск Дейкстры от вершины from. Поиск идёт по CSR-копии графа,
+// исходный граф нужен только для восстановления маршрута. Память линейна
+// по числу рёбер, построение мгновенное.
+//
+// В направлении INCOMING поиск идёт по обращённым рёбрам: дерево с корнем
+// root хранит для каждой вершины вес пути до root и первое ребро этого пути,
+// а BuildRoute(tree, vertex) возвращает маршрут vertex -> root. Аналогично
+// BuildRoute(from, to) в этом направлении возвращает маршрут to -> from.
+//
+// При беззнаковом целом Weight поиск без потенциала идёт по радикс-куче:
+// ключи такого поиска не убывают. Поиск A* использует двоичную кучу, так
+// как потенциал может нарушать монотонность ключей.
+//
+// Исходный граф может хранить веса другого типа GraphWeight: тогда веса
+// CSR-копии переводятся в Weight функцией, переданной в конструктор и
+// UpdateWeights. Поиск можно вести и по готовому CsrGraph без исходного
+// графа, например по CsrGraph::View над отображённым в память файлом:
+// тогда рёбра маршрута — номера дуг, а веса не меняются.
+template <typename Weight, typename GraphWeight = Weight>
+class DijkstraRouter {
+private:
+    using Graph = DirectedWeightedGraph<GraphWeight>;
+
+public:
+    using RouteInfo = typename Router<Weight>::RouteInfo;
+    using Tree = ShortestPathTree<Weight>;
+    // Вершина-источник поиска и её начальный вес
+    using Source = std::pair<VertexId, Weight>;
+
+    explicit DijkstraRouter(const Graph& graph, CsrDirection direction = CsrDirection::OUTGOING);
+    template <typename Convert>
+    DijkstraRouter(const Graph& graph, CsrDirection direction, Convert convert);
+    DijkstraRouter(CsrGraph<Weight> csr, CsrDirection direction);
+
+    // Перечитывает веса рёбер графа после их изменения; набор рёбер
+    // должен остаться прежним
+    void UpdateWeights();
+    template <typename Convert>
+    void UpdateWeights(Convert convert);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, SearchStats* stats = nullptr) const;
+
+    // Поиск A*: potential(vertex) — нижняя оценка веса пути от vertex до to.
+    // Оценка должна быть допустимой (не больше истинного веса), иначе
+    // найденный маршрут может оказаться не кратчайшим.
+    template <typename Potential>
+    std::optional<RouteInfo> BuildRouteAStar(VertexId from, VertexId to, Potential potential,
+                                             SearchStats* stats = nullptr) const;
+
+    // Строит полное дерево кратчайших путей от вершины from
+    Tree BuildShortestPathTree(VertexId from, SearchStats* stats = nullptr) const;
+
+    // Дерево одного поиска сразу из нескольких вершин: вес вершины —
+    // наименьшая по источникам сумма начального веса и веса пути от него.
+    // Путь в дереве начинается в источнике, через который вес наименьший.
+    Tree BuildShortestPathTree(const std::vector<Source>& sources, SearchStats* stats = nullptr) const;
+
+    // Восстанавливает маршрут по готовому дереву без нового поиска
+    std::optional<RouteInfo> BuildRoute(const Tree& tree, VertexId to) const;
+
+    // Вершины, до которых из from можно добраться с весом не больше max_weight,
+    // в порядке возрастания веса. Поиск не выходит за пределы этого веса.
+    std::vector<std::pair<VertexId, Weight>> FindReachableVertices(VertexId from, Weight max_weight,
+                                                                   SearchStats* stats = nullptr) const;
+
+private:
+    // Ключ очереди — вес пути плюс потенциал вершины
+    using QueueEntry = std::pair<Weight, VertexId>;
+
+    struct ZeroPotential {
+        Weight operator()(VertexId) const {
+            return ZERO_WEIGHT;
+        }
+    };
+
+    // Ключ радикс-кучи для Weight, отличного от беззнакового целого, не используется
+    using RadixKey = std::conditional_t<std::is_unsigned_v<Weight>, Weight, uint32_t>;
+
+    template <typename Potential>
+    static constexpr bool USE_RADIX_HEAP = std::is_unsigned_v<Weight> && std::is_same_v<Potential, ZeroPotential>;
+
+    // Рабочие массивы поиска, общие для всех запросов одного потока.
+    // Вершина считается достигнутой, только если её поколение совпадает
+    // с текущим, поэтому массивы не нужно очищать перед каждым поиском.
+    struct SearchState {
+        std::vector<Weight> weights;
+        std::vector<Weight> potentials;
+        std::vector<EdgeId> prev_edges;
+        std::vector<uint32_t> generations;
+        std::vector<QueueEntry> queue;
+        RadixHeap<RadixKey, VertexId> radix_queue;
+        uint32_t generation = 0;
+        size_t settled_count = 0;
+
+        void Reset(size_t vertex_count) {
+            if (generations.size() != vertex_count) {
+                weights.resize(vertex_count);
+                potentials.resize(vertex_count);
+                prev_edges.resize(vertex_count);
+                generations.assign(vertex_count, 0);
+                generation = 0;
+            }
+            if (++generation == 0) {
+                std::fill(generations.begin(), generations.end(), 0);
+                generation = 1;
+            }
+            queue.clear();
+            radix_queue.Clear();
+            settled_count = 0;
+        }
+
+        bool IsReached(VertexId vertex) const {
+            return generations[vertex] == generation;
+        }
+
+        void Reach(VertexId vertex, Weight weight, EdgeId prev_edge) {
+            generations[vertex] = generation;
+            weights[vertex] = weight;
+            prev_edges[vertex] = prev_edge;
+        }
+    };
+
+    static SearchState& GetSearchState(size_t vertex_count) {
+        thread_local SearchState state;
+        state.Reset(vertex_count);
+        return state;
+    }
+
+    // Вызывает on_settle(vertex, weight) для каждой вершины в порядке
+    // окончательного определения веса; поиск прекращается, когда on_settle
+    // возвращает false. Поиск начинается из source_count источников с их
+    // начальными весами. Потенциал вычисляется один раз на вершину; при
+    // нулевом потенциале это обычный алгоритм Дейкстры, иначе — A*.
+    template <typename Potential, typename OnSettle>
+    SearchState& RunSearch(const Source* sources, size_t source_count, Potential potential, OnSettle on_settle,
+                           SearchStats* stats) const;
+
+    Tree MakeTree(const SearchState& state) const;
+
+    template <typename PrevEdge>
+    std::vector<EdgeId> CollectEdges(VertexId to, PrevEdge prev_edge) const;
+
+    void CheckWeights() const;
+
+    void CheckVertex(VertexId vertex) const {
+        if (vertex >= csr_.GetVertexCount()) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = Tree::NO_EDGE;
+    const Graph* graph_ = nullptr;  // nullptr у поиска по готовому CsrGraph
+    CsrDirection direction_;
+    CsrGraph<Weight> csr_;
+};
+
+template <typename Weight, typename GraphWeight>
+DijkstraRouter<Weight, GraphWeight>::DijkstraRouter(const Graph& graph, CsrDirection direction)
+    : graph_(&graph)
+    , direction_(direction)
+    , csr_(graph, direction)
+{
+    CheckWeights();
+}
+
+template <typename Weight, typename GraphWeight>
+template <typename Convert>
+DijkstraRouter<Weight, GraphWeight>::DijkstraRouter(const Graph& graph, CsrDirection direction, Convert convert)
+    : graph_(&graph)
+    , direction_(direction)
+    , csr_(graph, direction, convert)
+{
+    CheckWeights();
+}
+
+template <typename Weight, typename GraphWeight>
+DijkstraRouter<Weight, GraphWeight>::DijkstraRouter(CsrGraph<Weight> csr, CsrDirection direction)
+    : direction_(direction)
+    , csr_(std::move(csr))
+{
+    CheckWeights();
+}
+
+template <typename Weight, typename GraphWeight>
+void DijkstraRouter<Weight, GraphWeight>::UpdateWeights() {
+    if (!graph_) {
+        throw std::logic_error("Router has no source graph");
+    }
+    if (csr_.GetEdgeCount() != graph_->GetEdgeCount()) {
+        throw std::logic_error("Edge count of the graph has changed");
+    }
+    csr_.UpdateWeights(*graph_);
+    CheckWeights();
+}
+
+template <typename Weight, typename GraphWeight>
+template <typename Convert>
+void DijkstraRouter<Weight, GraphWeight>::UpdateWeights(Convert convert) {
+    if (!graph_) {
+        throw std::logic_error("Router has no source graph");
+    }
+    if (csr_.GetEdgeCount() != graph_->GetEdgeCount()) {
+        throw std::logic_error("Edge count of the graph has changed");
+    }
+    csr_.UpdateWeights(*graph_, convert);
+    CheckWeights();
+}
+
+template <typename Weight, typename GraphWeight>
+void DijkstraRouter<Weight, GraphWeight>::CheckWeights() const {
+    for (size_t arc = 0; arc < csr_.GetEdgeCount(); ++arc) {
+        if (csr_.GetWeight(arc) < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight, typename GraphWeight>
+template <typename Potential, typename OnSettle>
+typename DijkstraRouter<Weight, GraphWeight>::SearchState& DijkstraRouter<Weight, GraphWeight>::RunSearch(
+    const Source* sources, size_t source_count, Potential potential, OnSettle on_settle, SearchStats* stats) const {
+    for (size_t k = 0; k < source_count; ++k) {
+        CheckVertex(sources[k].first);
+    }
+    SearchState& state = GetSearchState(csr_.GetVertexCount());
+    auto& queue = state.queue;
+    const auto cmp = std::greater<QueueEntry>{};
+    const auto push = [&state, &queue, cmp](Weight key, VertexId vertex) {
+        if constexpr (USE_RADIX_HEAP<Potential>) {
+            state.radix_queue.Push(key, vertex);
+        } else {
+            queue.push_back({key, vertex});
+            std::push_heap(queue.begin(), queue.end(), cmp);
+        }
+    };
+    const auto pop = [&state, &queue, cmp]() -> QueueEntry {
+        if constexpr (USE_RADIX_HEAP<Potential>) {
+            return state.radix_queue.Pop();
+        } else {
+            std::pop_heap(queue.begin(), queue.end(), cmp);
+            const QueueEntry entry = queue.back();
+            queue.pop_back();
+            return entry;
+        }
+    };
+    const auto is_empty = [&state, &queue] {
+        if constexpr (USE_RADIX_HEAP<Potential>) {
+            return state.radix_queue.IsEmpty();
+        } else {
+            return queue.empty();
+        }
+    };
+
+    for (size_t k = 0; k < source_count; ++k) {
+        const auto& [vertex, weight] = sources[k];
+        if (weight < ZERO_WEIGHT) {
+            throw std::domain_error("Initial weights should be non-negative");
+        }
+        if (!state.IsReached(vertex)) {
+            state.potentials[vertex] = potential(vertex);
+        } else if (!(weight < state.weights[vertex])) {
+            continue;
+        }
+        state.Reach(vertex, weight, NO_EDGE);
+        push(weight + state.potentials[vertex], vertex);
+    }
+    while (!is_empty()) {
+        const auto [key, vertex] = pop();
+        // Устаревшая запись: вершина уже извлечена с меньшим весом
+        if (state.weights[vertex] + state.potentials[vertex] < key) {
+            continue;
+        }
+        ++state.settled_count;
+        const Weight weight = state.weights[vertex];
+        if (!on_settle(vertex, weight)) {
+            break;
+        }
+        for (size_t arc = csr_.GetArcsBegin(vertex), end = csr_.GetArcsEnd(vertex); arc < end; ++arc) {
+            const VertexId next = csr_.GetTarget(arc);
+            const Weight candidate_weight = weight + csr_.GetWeight(arc);
+            if (!state.IsReached(next)) {
+                state.potentials[next] = potential(next);
+            } else if (!(candidate_weight < state.weights[next])) {
+                continue;
+            }
+            state.Reach(next, candidate_weight, csr_.GetEdgeId(arc));
+            push(candidate_weight + state.potentials[next], next);
+        }
+    }
+    if (stats) {
+        stats->settled_vertices += state.settled_count;
+    }
+    return state;
+}
+
+template <typename Weight, typename GraphWeight>
+template <typename PrevEdge>
+std::vector<EdgeId> DijkstraRouter<Weight, GraphWeight>::CollectEdges(VertexId to, PrevEdge prev_edge) const {
+    const bool outgoing = direction_ == CsrDirection::OUTGOING;
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = prev_edge(to); edge_id != NO_EDGE;) {
+        edges.push_back(edge_id);
+        // Без исходного графа ребро — дуга, и предыдущая вершина пути — её владелец
+        if (graph_) {
+            const auto& edge = graph_->GetEdge(edge_id);
+            edge_id = prev_edge(outgoing ? edge.from : edge.to);
+        } else {
+            edge_id = prev_edge(csr_.GetArcOwner(edge_id));
+        }
+    }
+    if (outgoing) {
+        std::reverse(edges.begin(), edges.end());
+    }
+    return edges;
+}
+
+template <typename Weight, typename GraphWeight>
+std::optional<typename DijkstraRouter<Weight, GraphWeight>::RouteInfo> DijkstraRouter<Weight, GraphWeight>::BuildRoute(
+    VertexId from, VertexId to, SearchStats* stats) const {
+    return BuildRouteAStar(from, to, ZeroPotential{}, stats);
+}
+
+template <typename Weight, typename GraphWeight>
+template <typename Potential>
+std::optional<typename DijkstraRouter<Weight, GraphWeight>::RouteInfo>
+DijkstraRouter<Weight, GraphWeight>::BuildRouteAStar(VertexId from, VertexId to, Potential potential,
+                                                     SearchStats* stats) const {
+    CheckVertex(to);
+    const Source source{from, ZERO_WEIGHT};
+    const SearchState& state = RunSearch(&source, 1, potential, [to](VertexId vertex, Weight) {
+        return vertex != to;
+    }, stats);
+    if (!state.IsReached(to)) {
+        return std::nullopt;
+    }
+    auto edges = CollectEdges(to, [&state](VertexId vertex) {
+        return state.prev_edges[vertex];
+    });
+    return RouteInfo{state.weights[to], std::move(edges)};
+}
+
+template <typename Weight, typename GraphWeight>
+typename DijkstraRouter<Weight, GraphWeight>::Tree DijkstraRouter<Weight, GraphWeight>::BuildShortestPathTree(
+    VertexId from, SearchStats* stats) const {
+    const Source source{from, ZERO_WEIGHT};
+    const SearchState& state = RunSearch(&source, 1, ZeroPotential{}, [](VertexId, Weight) {
+        return true;
+    }, stats);
+    Tree tree = MakeTree(state);
+    tree.root = from;
+    return tree;
+}
+
+template <typename Weight, typename GraphWeight>
+typename DijkstraRouter<Weight, GraphWeight>::Tree DijkstraRouter<Weight, GraphWeight>::BuildShortestPathTree(
+    const std::vector<Source>& sources, SearchStats* stats) const {
+    if (sources.empty()) {
+        throw std::invalid_argument("No sources for the search");
+    }
+    const SearchState& state = RunSearch(sources.data(), sources.size(), ZeroPotential{}, [](VertexId, Weight) {
+        return true;
+    }, stats);
+    Tree tree = MakeTree(state);
+    tree.root = sources.front().first;
+    for (const auto& [vertex, weight] : sources) {
+        if (vertex != tree.root) {
+            tree.other_roots.push_back(vertex);
+        }
+    }
+    std::sort(tree.other_roots.begin(), tree.other_roots.end());
+    tree.other_roots.erase(std::unique(tree.other_roots.begin(), tree.other_roots.end()), tree.other_roots.end());
+    return tree;
+}
+
+template <typename Weight, typename GraphWeight>
+typename DijkstraRouter<Weight, GraphWeight>::Tree DijkstraRouter<Weight, GraphWeight>::MakeTree(
+    const SearchState& state) const {
+    const size_t vertex_count = csr_.GetVertexCount();
+    Tree tree;
+    tree.weights.assign(vertex_count, ZERO_WEIGHT);
+    tree.prev_edges.assign(vertex_count, NO_EDGE);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        if (state.IsReached(vertex)) {
+            tree.weights[vertex] = state.weights[vertex];
+            tree.prev_edges[vertex] = state.prev_edges[vertex];
+        }
+    }
+    return tree;
+}
+
+template <typename Weight, typename GraphWeight>
+std::optional<typename DijkstraRouter<Weight, GraphWeight>::RouteInfo> DijkstraRouter<Weight, GraphWeight>::BuildRoute(
+    const Tree& tree, VertexId to) const {
+    CheckVertex(to);
+    if (!tree.IsReachable(to)) {
+        return std::nullopt;
+    }
+    auto edges = CollectEdges(to, [&tree](VertexId vertex) {
+        return tree.prev_edges[vertex];
+    });
+    return RouteInfo{tree.weights[to], std::move(edges)};
+}
+
+template <typename Weight, typename GraphWeight>
+std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight, GraphWeight>::FindReachableVertices(
+    VertexId from, Weight max_weight, SearchStats* stats) const {
+    std::vector<std::pair<VertexId, Weight>> vertices;
+    const Source source{from, ZERO_WEIGHT};
+    RunSearch(&source, 1, ZeroPotential{}, [&vertices, max_weight](VertexId vertex, Weight weight) {
+        if (max_weight < weight) {
+            return false;
+        }
+        vertices.emplace_back(vertex, weight);
+        return true;
+    }, stats);
+    return vertices;
+}
+
+}  // namespace graph
@@ -0,0 +1,73 @@
+#include "distance_table.h"
+
+namespace TransportCatalog {
+namespace Transport {
+
+void DistanceTable::Set(Domain::StopId from, Domain::StopId to, int distance) {
+    Put(MakeKey(from, to), distance, true);
+    Put(MakeKey(to, from), distance, false);
+}
+
+int DistanceTable::Get(Domain::StopId from, Domain::StopId to) const {
+    if (slots_.empty()) {
+        return 0;
+    }
+    const Slot& slot = slots_[FindSlot(MakeKey(from, to))];
+    return slot.key == EMPTY_KEY ? 0 : slot.distance;
+}
+
+// Финальное перемешивание splitmix64: каждый бит ключа влияет на все биты результата
+uint64_t DistanceTable::Mix(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+size_t DistanceTable::FindSlot(uint64_t key) const {
+    const size_t mask = slots_.size() - 1;
+    size_t index = Mix(key) & mask;
+    while (slots_[index].key != EMPTY_KEY && slots_[index].key != key) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+// Явное значение заменяет любое, неявное — только неявное
+void DistanceTable::Put(uint64_t key, int distance, bool is_explicit) {
+    if (slots_.empty()) {
+        Grow();
+    }
+    size_t index = FindSlot(key);
+    if (slots_[index].key != EMPTY_KEY) {
+        Slot& slot = slots_[index];
+        if (is_explicit || !slot.is_explicit) {
+            slot.distance = distance;
+            slot.is_explicit = slot.is_explicit || is_explicit;
+        }
+        return;
+    }
+    // Заполненность не выше половины держит цепочки пробирования короткими;
+    // растем только при вставке нового ключа
+    if ((size_ + 1) * 2 > slots_.size()) {
+        Grow();
+        index = FindSlot(key);
+    }
+    slots_[index] = {key, distance, is_explicit};
+    ++size_;
+}
+
+void DistanceTable::Grow() {
+    std::vector<Slot> old_slots(slots_.empty() ? 16 : slots_.size() * 2);
+    old_slots.swap(slots_);
+    for (const Slot& slot : old_slots) {
+        if (slot.key != EMPTY_KEY) {
+            slots_[FindSlot(slot.key)] = slot;
+        }
+    }
+}
+
+} // namespace Transport
+} // namespace TransportCatalog
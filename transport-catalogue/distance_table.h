@@ -0,0 +1,69 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace TransportCatalog {
+namespace Transport {
+
+// Дорожные расстояния между остановками: плоская таблица с открытой
+// адресацией и линейным пробированием. Ключ — пара номеров остановок
+// в одном 64-битном числе, перемешанная перед выбором ячейки, так что
+// соседние номера не попадают в соседние ячейки. Обратное расстояние
+// записывается при Set, если оно не задано явно, поэтому Get — один поиск.
+class DistanceTable {
+public:
+    // Задает расстояние from -> to; to -> from получает то же значение,
+    // пока для него не задано свое
+    void Set(Domain::StopId from, Domain::StopId to, int distance);
+
+    // Расстояние from -> to или обратное, если прямое не задано; 0 — не задано ни одно
+    int Get(Domain::StopId from, Domain::StopId to) const;
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+    size_t GetMemoryUsage() const {
+        return slots_.capacity() * sizeof(Slot);
+    }
+
+    // Вызывает callback(from, to, distance) для каждого явно заданного расстояния
+    template <typename Callback>
+    void ForEachExplicit(Callback callback) const {
+        for (const Slot& slot : slots_) {
+            if (slot.key != EMPTY_KEY && slot.is_explicit) {
+                callback(static_cast<Domain::StopId>(slot.key >> 32), static_cast<Domain::StopId>(slot.key),
+                         slot.distance);
+            }
+        }
+    }
+
+private:
+    // Ключ пустой ячейки; пару из двух наибольших номеров справочник не выдает
+    static constexpr uint64_t EMPTY_KEY = UINT64_MAX;
+
+    struct Slot {
+        uint64_t key = EMPTY_KEY;
+        int distance = 0;
+        bool is_explicit = false;  // задано для этого направления, а не взято из обратного
+    };
+
+    static uint64_t MakeKey(Domain::StopId from, Domain::StopId to) {
+        return static_cast<uint64_t>(from) << 32 | to;
+    }
+    static uint64_t Mix(uint64_t key);
+
+    // Ячейка с ключом или пустая ячейка, где ему место
+    size_t FindSlot(uint64_t key) const;
+    void Put(uint64_t key, int distance, bool is_explicit);
+    void Grow();
+
+    std::vector<Slot> slots_;  // размер — степень двойки
+    size_t size_ = 0;
+};
+
+} // namespace Transport
+} // namespace TransportCatalog
@@ -1,20 +1,27 @@
 #pragma once
 #include "geo.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace Domain {
 
-// Хранит имя и координаты остановки
+// Номера остановок и автобусов подряд с нуля в порядке добавления в справочник
+using StopId = uint32_t;
+using BusId = uint32_t;
+
+// Хранит номер, имя и координаты остановки
 struct Stop {
+    StopId id;
     std::string name;
     Geo::Coordinates coordinates;
 };
 
-// Хранит имя, остановки и тип маршрута
+// Хранит номер, имя, номера остановок и тип маршрута
 struct Bus {
+    BusId id;
     std::string name;
-    std::vector<const Stop*> stops;
+    std::vector<StopId> stops;
     bool is_circular;
 };
 
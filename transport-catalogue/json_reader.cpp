@@ -1,120 +1,65 @@
 #include "json_reader.h"
 #include <sstream>
+#include <stdexcept>
 
 namespace json_reader {
 
-JsonReader::JsonReader(TransportCatalog::Transport::TransportCatalogue& db, 
-                       const RenderSettings& render_settings,
-                       const TransportRouter& router)
-    : db_(db), handler_(db), renderer_(render_settings), router_(router) {}
+JsonReader::JsonReader(const RenderSettings& render_settings, const TransportRouter& router)
+    : renderer_(render_settings), router_(router) {}
 
+// Маршрутизатор уже построен по заполненному справочнику
 void JsonReader::ProcessRequests(const json::Document& doc) {
     const json::Dict& root = doc.GetRoot().AsDict();
-    ProcessBaseRequests(root.at("base_requests").AsArray());
+    snapshots_.Publish(router_.GetCatalogue());
     ProcessStatRequests(root.at("stat_requests").AsArray());
 }
 
-void JsonReader::ProcessBaseRequests(const json::Array& base_requests) {
-    // Сначала добавляем все остановки
-    for (const json::Node& request : base_requests) {
-        const json::Dict& req_map = request.AsDict();
-        if (req_map.at("type").AsString() == "Stop") {
-            AddStop(req_map);
-        }
-    }
-    
-    // Устанавливаем расстояния между остановками
-    for (const auto& [from, to, distance] : distances_to_set_) {
-        const Domain::Stop* from_ = db_.FindStop(from);
-        const Domain::Stop* to_ = db_.FindStop(to);
-        db_.SetDistance(from_, to_, distance);  
-    }
-    
-    // Затем добавляем все маршруты
-    for (const json::Node& request : base_requests) {
-        const json::Dict& req_map = request.AsDict();
-        if (req_map.at("type").AsString() == "Bus") {
-            AddBus(req_map);
-        }
-    }
-}
+namespace {
 
-void JsonReader::AddStop(const json::Dict& stop_dict) {
-    std::string name = stop_dict.at("name").AsString();
-    double lat = stop_dict.at("latitude").AsDouble();
-    double lon = stop_dict.at("longitude").AsDouble();
-    
-    db_.AddStop(name, {lat, lon});
-    
-    if (stop_dict.count("road_distances")) {
-        const auto& distances = stop_dict.at("road_distances").AsDict();
-        for (const auto& [stop_name, distance] : distances) {
-            int dist = distance.AsInt();
-            distances_to_set_.emplace_back(name, stop_name, dist);
-        }
-    }
-}
+using TransportCatalog::Transport::CatalogueImage;
+using TransportCatalog::Transport::CatalogueSnapshot;
 
-void JsonReader::AddBus(const json::Dict& bus_dict) {
-    std::string name = bus_dict.at("name").AsString();
-    std::vector<std::string> stops;
-    for (const json::Node& stop : bus_dict.at("stops").AsArray()) {
-        stops.push_back(stop.AsString());
-    }
-    bool is_roundtrip = bus_dict.at("is_roundtrip").AsBool();
-    
-    db_.AddBus(name, stops, is_roundtrip);
-}
-
-void JsonReader::ProcessStatRequests(const json::Array& stat_requests) {
+// Маршруты пакета строятся одним вызовом до формирования ответов
+std::vector<std::pair<std::string_view, std::string_view>> CollectRouteRequests(const json::Array& stat_requests) {
+    std::vector<std::pair<std::string_view, std::string_view>> route_requests;
     for (const json::Node& request : stat_requests) {
         const json::Dict& req_map = request.AsDict();
-        json::Builder response_builder; 
-
-        if (req_map.at("type").AsString() == "Bus") {
-            ProcessBusRequest(req_map, response_builder);
-        } else if (req_map.at("type").AsString() == "Stop") {
-            ProcessStopRequest(req_map, response_builder);
-        } else if (req_map.at("type").AsString() == "Map") {
-            ProcessMapRequest(req_map, response_builder); 
-        } else if (req_map.at("type").AsString() == "Route") {
-            ProcessRouteRequest(req_map, response_builder);
+        if (req_map.at("type").AsString() == "Route") {
+            route_requests.emplace_back(req_map.at("from").AsString(), req_map.at("to").AsString());
         }
-
-        responses_.push_back(response_builder.Build());
     }
+    return route_requests;
 }
 
-void JsonReader::ProcessMapRequest(const json::Dict& request, json::Builder& response_builder) {
-    int id = request.at("id").AsInt();
-
-    std::vector<const Domain::Bus*> buses;
-    for (const auto& [name, bus] : db_.GetAllBuses()) {
-        buses.push_back(bus);
+// Остановки запроса Matrix; all_stops_found сбрасывается, если какой-то нет
+template <typename FindStop>
+std::vector<std::string_view> ReadMatrixStops(const json::Array& names, FindStop find_stop, bool& all_stops_found) {
+    std::vector<std::string_view> stops;
+    stops.reserve(names.size());
+    for (const json::Node& name : names) {
+        stops.push_back(name.AsString());
+        all_stops_found = all_stops_found && find_stop(stops.back());
     }
+    return stops;
+}
 
-    std::ostringstream svg_stream;
-    svg::Document map = renderer_.RenderMap(buses);
-    map.Render(svg_stream);
-    std::string svg_string = svg_stream.str();
-
-   response_builder.StartDict()
-        .Key("map").Value(svg_string)
+void BuildNotFoundResponse(int id, json::Builder& response_builder) {
+    response_builder.StartDict()
         .Key("request_id").Value(id)
+        .Key("error_message").Value("not found")
         .EndDict();
 }
 
-void JsonReader::ProcessBusRequest(const json::Dict& request, json::Builder& response_builder) {
-    int id = request.at("id").AsInt();
-    const std::string& name = request.at("name").AsString();
-    
-    auto bus_info = handler_.GetBusStat(name);
+void BuildMapResponse(int id, std::string svg_string, json::Builder& response_builder) {
+    response_builder.StartDict()
+        .Key("map").Value(std::move(svg_string))
+        .Key("request_id").Value(id)
+        .EndDict();
+}
 
+void BuildBusResponse(int id, const std::optional<const Domain::BusInfo>& bus_info, json::Builder& response_builder) {
     if (!bus_info) {
-        response_builder.StartDict()
-            .Key("request_id").Value(id)
-            .Key("error_message").Value("not found")
-            .EndDict();
+        BuildNotFoundResponse(id, response_builder);
         return;
     }
     
@@ -127,17 +72,10 @@ void JsonReader::ProcessBusRequest(const json::Dict& request, json::Builder& res
         .EndDict();
 }
 
-void JsonReader::ProcessStopRequest(const json::Dict& request, json::Builder& response_builder) {
-    int id = request.at("id").AsInt();
-    const std::string& name = request.at("name").AsString(); 
-
-    auto stop_info = handler_.GetStopInfo(name);
-
+template <typename BusNames>
+void BuildStopResponse(int id, const std::optional<BusNames>& stop_info, json::Builder& response_builder) {
     if (!stop_info) {
-        response_builder.StartDict()
-            .Key("request_id").Value(id)
-            .Key("error_message").Value("not found")
-            .EndDict();
+        BuildNotFoundResponse(id, response_builder);
         return;
     }
     
@@ -153,18 +91,10 @@ void JsonReader::ProcessStopRequest(const json::Dict& request, json::Builder& re
     response_builder.EndDict();
 }
 
-void JsonReader::ProcessRouteRequest(const json::Dict& request, json::Builder& response_builder) {
-    int id = request.at("id").AsInt();
-    std::string from = request.at("from").AsString();
-    std::string to = request.at("to").AsString();
-
-    auto route = router_.BuildRoute(from, to);
-
+void BuildRouteResponse(int id, const std::optional<TransportRouter::RouteInfo>& route,
+                        json::Builder& response_builder) {
     if (!route) {
-        response_builder.StartDict()
-            .Key("request_id").Value(id)
-            .Key("error_message").Value("not found")
-            .EndDict();
+        BuildNotFoundResponse(id, response_builder);
         return;
     }
 
@@ -187,10 +117,189 @@ void JsonReader::ProcessRouteRequest(const json::Dict& request, json::Builder& r
     response_builder.EndArray().EndDict();
 }
 
+// Строка матрицы на каждую остановку отправления, null — маршрута нет
+void BuildMatrixResponse(int id, size_t row_count, size_t column_count, const std::vector<std::optional<double>>& times,
+                         json::Builder& response_builder) {
+    response_builder.StartDict()
+        .Key("request_id").Value(id)
+        .Key("times").StartArray();
+    for (size_t row = 0; row < row_count; ++row) {
+        response_builder.StartArray();
+        for (size_t column = 0; column < column_count; ++column) {
+            const auto& time = times[row * column_count + column];
+            if (time) {
+                response_builder.Value(*time);
+            } else {
+                response_builder.Value(nullptr);
+            }
+        }
+        response_builder.EndArray();
+    }
+    response_builder.EndArray().EndDict();
+}
+
+void BuildIsochroneResponse(int id, const std::vector<TransportRouter::ReachableStop>& stops,
+                            json::Builder& response_builder) {
+    response_builder.StartDict()
+        .Key("request_id").Value(id)
+        .Key("stops").StartArray();
+    for (const auto& stop : stops) {
+        response_builder.StartDict()
+            .Key("stop_name").Value(std::string(stop.name))
+            .Key("time").Value(stop.time)
+            .EndDict();
+    }
+    response_builder.EndArray().EndDict();
+}
+
+} // namespace
+
+void JsonReader::ProcessStatRequests(const json::Array& stat_requests) {
+    // Весь пакет отвечает по одному снимку, даже если тем временем опубликован новый
+    const auto snapshot = snapshots_.Acquire();
+    const auto& db = *snapshot;
+
+    const auto routes = router_.BuildRoutes(CollectRouteRequests(stat_requests));
+    size_t route_index = 0;
+
+    for (const json::Node& request : stat_requests) {
+        const json::Dict& req_map = request.AsDict();
+        json::Builder response_builder; 
+
+        if (req_map.at("type").AsString() == "Bus") {
+            ProcessBusRequest(db, req_map, response_builder);
+        } else if (req_map.at("type").AsString() == "Stop") {
+            ProcessStopRequest(db, req_map, response_builder);
+        } else if (req_map.at("type").AsString() == "Map") {
+            ProcessMapRequest(db, req_map, response_builder); 
+        } else if (req_map.at("type").AsString() == "Route") {
+            BuildRouteResponse(req_map.at("id").AsInt(), routes[route_index++], response_builder);
+        } else if (req_map.at("type").AsString() == "Matrix") {
+            ProcessMatrixRequest(db, req_map, response_builder);
+        } else if (req_map.at("type").AsString() == "Isochrone") {
+            ProcessIsochroneRequest(db, req_map, response_builder);
+        }
+
+        responses_.push_back(response_builder.Build());
+    }
+}
+
+void JsonReader::ProcessMapRequest(const CatalogueSnapshot& db,
+                                   const json::Dict& request, json::Builder& response_builder) {
+    BuildMapResponse(request.at("id").AsInt(), RenderMap(renderer_, db), response_builder);
+}
+
+void JsonReader::ProcessBusRequest(const CatalogueSnapshot& db,
+                                   const json::Dict& request, json::Builder& response_builder) {
+    const std::string& name = request.at("name").AsString();
+    BuildBusResponse(request.at("id").AsInt(), RequestHandler(db).GetBusStat(name), response_builder);
+}
+
+void JsonReader::ProcessStopRequest(const CatalogueSnapshot& db,
+                                    const json::Dict& request, json::Builder& response_builder) {
+    const std::string& name = request.at("name").AsString(); 
+    BuildStopResponse(request.at("id").AsInt(), RequestHandler(db).GetStopInfo(name), response_builder);
+}
+
+void JsonReader::ProcessMatrixRequest(const CatalogueSnapshot& db,
+                                      const json::Dict& request, json::Builder& response_builder) {
+    int id = request.at("id").AsInt();
+
+    bool all_stops_found = true;
+    auto find_stop = [&db](std::string_view name) {
+        return db.FindStop(name) != nullptr;
+    };
+    const auto origins = ReadMatrixStops(request.at("origins").AsArray(), find_stop, all_stops_found);
+    const auto destinations = ReadMatrixStops(request.at("destinations").AsArray(), find_stop, all_stops_found);
+
+    if (!all_stops_found) {
+        BuildNotFoundResponse(id, response_builder);
+        return;
+    }
+    BuildMatrixResponse(id, origins.size(), destinations.size(),
+                        router_.BuildTravelTimeMatrix(origins, destinations), response_builder);
+}
+
+void JsonReader::ProcessIsochroneRequest(const CatalogueSnapshot& db,
+                                         const json::Dict& request, json::Builder& response_builder) {
+    int id = request.at("id").AsInt();
+    const std::string& from = request.at("from").AsString();
+    double max_time = request.at("max_time").AsDouble();
+
+    if (!db.FindStop(from)) {
+        BuildNotFoundResponse(id, response_builder);
+        return;
+    }
+    BuildIsochroneResponse(id, router_.FindReachableStops(from, max_time), response_builder);
+}
+
 const json::Array& JsonReader::GetResponses() const {
     return responses_;
 }
 
+json::Array ProcessStatRequests(const CatalogueImage& image, const json::Array& stat_requests) {
+    const auto routes = image.BuildRoutes(CollectRouteRequests(stat_requests));
+    size_t route_index = 0;
+
+    json::Array responses;
+    for (const json::Node& request : stat_requests) {
+        const json::Dict& req_map = request.AsDict();
+        const std::string& type = req_map.at("type").AsString();
+        const int id = req_map.at("id").AsInt();
+        json::Builder response_builder;
+
+        if (type == "Bus") {
+            const auto bus = image.FindBus(req_map.at("name").AsString());
+            BuildBusResponse(id, bus ? std::optional<const Domain::BusInfo>(image.GetBusInfo(*bus)) : std::nullopt,
+                             response_builder);
+        } else if (type == "Stop") {
+            const auto stop = image.FindStop(req_map.at("name").AsString());
+            BuildStopResponse(id, stop ? std::optional(image.GetBusNamesByStop(*stop)) : std::nullopt,
+                              response_builder);
+        } else if (type == "Map") {
+            BuildMapResponse(id, std::string(image.GetMap()), response_builder);
+        } else if (type == "Route") {
+            BuildRouteResponse(id, routes[route_index++], response_builder);
+        } else if (type == "Matrix") {
+            bool all_stops_found = true;
+            auto find_stop = [&image](std::string_view name) {
+                return image.FindStop(name).has_value();
+            };
+            const auto origins = ReadMatrixStops(req_map.at("origins").AsArray(), find_stop, all_stops_found);
+            const auto destinations = ReadMatrixStops(req_map.at("destinations").AsArray(), find_stop, all_stops_found);
+            if (all_stops_found) {
+                BuildMatrixResponse(id, origins.size(), destinations.size(),
+                                    image.BuildTravelTimeMatrix(origins, destinations), response_builder);
+            } else {
+                BuildNotFoundResponse(id, response_builder);
+            }
+        } else if (type == "Isochrone") {
+            const std::string& from = req_map.at("from").AsString();
+            if (image.FindStop(from)) {
+                BuildIsochroneResponse(id, image.FindReachableStops(from, req_map.at("max_time").AsDouble()),
+                                       response_builder);
+            } else {
+                BuildNotFoundResponse(id, response_builder);
+            }
+        }
+
+        responses.push_back(response_builder.Build());
+    }
+    return responses;
+}
+
+std::string RenderMap(const MapRenderer& renderer, const CatalogueSnapshot& db) {
+    std::vector<const Domain::Bus*> buses;
+    for (const auto& bus : db.GetAllBuses()) {
+        buses.push_back(&bus);
+    }
+
+    std::ostringstream svg_stream;
+    svg::Document map = renderer.RenderMap(buses, db);
+    map.Render(svg_stream);
+    return svg_stream.str();
+}
+
 void FillTransportCatalogue(TransportCatalog::Transport::TransportCatalogue& catalog, const json::Array& base_requests) {
     for (const auto& request : base_requests) {
         const auto& req = request.AsDict();
@@ -212,7 +321,7 @@ void FillTransportCatalogue(TransportCatalog::Transport::TransportCatalogue& cat
             const std::string& name = req.at("name").AsString();
             const auto& distances = req.at("road_distances").AsDict();
             for (const auto& [to, distance] : distances) {
-                catalog.SetDistance(catalog.FindStop(name), catalog.FindStop(to), distance.AsInt());
+                catalog.SetDistance(catalog.FindStop(name)->id, catalog.FindStop(to)->id, distance.AsInt());
             }
         } else if (type == "Bus") {
             const std::string& name = req.at("name").AsString();
@@ -227,6 +336,65 @@ void FillTransportCatalogue(TransportCatalog::Transport::TransportCatalogue& cat
     }
 }
 
+void ApplyUpdates(TransportCatalog::Transport::TransportCatalogue& catalog, TransportRouter& router,
+                  const json::Dict& updates) {
+    const json::Array no_requests;
+    const json::Array& base_requests = updates.count("base_requests") ? updates.at("base_requests").AsArray()
+                                                                      : no_requests;
+    // Сначала меняется справочник, затем маршрутизатор по его новому снимку
+    std::vector<std::string> new_stops;
+    for (const auto& request : base_requests) {
+        const auto& req = request.AsDict();
+        const std::string& name = req.at("name").AsString();
+        if (req.at("type").AsString() == "Stop" && !catalog.FindStop(name)) {
+            catalog.AddStop(name, {req.at("latitude").AsDouble(), req.at("longitude").AsDouble()});
+            new_stops.push_back(name);
+        }
+    }
+
+    for (const auto& request : base_requests) {
+        const auto& req = request.AsDict();
+        const std::string& type = req.at("type").AsString();
+
+        if (type == "Stop" && req.count("road_distances")) {
+            const std::string& name = req.at("name").AsString();
+            for (const auto& [to, distance] : req.at("road_distances").AsDict()) {
+                catalog.SetDistance(catalog.FindStop(name)->id, catalog.FindStop(to)->id, distance.AsInt());
+            }
+        } else if (type == "Bus") {
+            const std::string& name = req.at("name").AsString();
+            std::vector<std::string> stop_names;
+            for (const auto& stop : req.at("stops").AsArray()) {
+                stop_names.push_back(stop.AsString());
+            }
+            catalog.AddBus(name, stop_names, req.at("is_roundtrip").AsBool());
+        }
+    }
+
+    router.UpdateCatalogue(catalog.Freeze());
+    for (const auto& request : base_requests) {
+        const auto& req = request.AsDict();
+        const std::string& type = req.at("type").AsString();
+        const std::string& name = req.at("name").AsString();
+        if (type == "Stop" && req.count("road_distances")) {
+            for (const auto& distance : req.at("road_distances").AsDict()) {
+                router.UpdateDistance(name, distance.first);
+            }
+        } else if (type == "Bus") {
+            router.AddBus(name);
+        }
+    }
+
+    // Остановки новых автобусов уже в графе, осталось добавить остальные
+    for (const std::string& name : new_stops) {
+        router.AddStop(name);
+    }
+
+    if (updates.count("routing_settings")) {
+        router.UpdateSettings(ParseRoutingSettings(updates.at("routing_settings").AsDict()));
+    }
+}
+
 RenderSettings ParseRenderSettings(const json::Dict& render_settings) {
     RenderSettings settings;
     settings.width = render_settings.at("width").AsDouble();
@@ -251,6 +419,74 @@ RenderSettings ParseRenderSettings(const json::Dict& render_settings) {
     return settings;
 }
 
+RoutingSettings ParseRoutingSettings(const json::Dict& routing_settings) {
+    RoutingSettings settings;
+    settings.bus_wait_time = routing_settings.at("bus_wait_time").AsInt();
+    settings.bus_velocity = routing_settings.at("bus_velocity").AsDouble();
+
+    if (routing_settings.count("strategy")) {
+        const std::string& strategy = routing_settings.at("strategy").AsString();
+        if (strategy == "auto") {
+            settings.strategy = RoutingSettings::Strategy::AUTO;
+        } else if (strategy == "all_pairs") {
+            settings.strategy = RoutingSettings::Strategy::ALL_PAIRS;
+        } else if (strategy == "dijkstra") {
+            settings.strategy = RoutingSettings::Strategy::DIJKSTRA;
+        } else if (strategy == "contraction_hierarchy") {
+            settings.strategy = RoutingSettings::Strategy::CONTRACTION_HIERARCHY;
+        } else if (strategy == "all_pairs_compact") {
+            settings.strategy = RoutingSettings::Strategy::ALL_PAIRS_COMPACT;
+        } else {
+            throw std::invalid_argument("Unknown routing strategy: " + strategy);
+        }
+    }
+    if (routing_settings.count("heuristic")) {
+        const std::string& heuristic = routing_settings.at("heuristic").AsString();
+        if (heuristic == "none") {
+            settings.heuristic = RoutingSettings::Heuristic::NONE;
+        } else if (heuristic == "geo") {
+            settings.heuristic = RoutingSettings::Heuristic::GEO;
+        } else if (heuristic == "landmarks") {
+            settings.heuristic = RoutingSettings::Heuristic::LANDMARKS;
+        } else {
+            throw std::invalid_argument("Unknown routing heuristic: " + heuristic);
+        }
+    }
+    if (routing_settings.count("graph_model")) {
+        const std::string& graph_model = routing_settings.at("graph_model").AsString();
+        if (graph_model == "pairwise") {
+            settings.graph_model = RoutingSettings::GraphModel::PAIRWISE;
+        } else if (graph_model == "compact") {
+            settings.graph_model = RoutingSettings::GraphModel::COMPACT;
+        } else {
+            throw std::invalid_argument("Unknown routing graph model: " + graph_model);
+        }
+    }
+    if (routing_settings.count("prune_parallel_edges")) {
+        settings.prune_parallel_edges = routing_settings.at("prune_parallel_edges").AsBool();
+    }
+    if (routing_settings.count("fixed_point_weights")) {
+        settings.fixed_point_weights = routing_settings.at("fixed_point_weights").AsBool();
+    }
+    if (routing_settings.count("compress_chains")) {
+        settings.compress_chains = routing_settings.at("compress_chains").AsBool();
+    }
+    if (routing_settings.count("landmark_count")) {
+        settings.landmark_count = routing_settings.at("landmark_count").AsInt();
+    }
+    if (routing_settings.count("memory_budget_mb")) {
+        settings.memory_budget_bytes = static_cast<size_t>(routing_settings.at("memory_budget_mb").AsInt()) << 20;
+    }
+    if (routing_settings.count("tree_cache_mb")) {
+        settings.tree_cache_bytes = static_cast<size_t>(routing_settings.at("tree_cache_mb").AsInt()) << 20;
+    }
+    if (routing_settings.count("log_stats")) {
+        settings.log_stats = routing_settings.at("log_stats").AsBool();
+    }
+
+    return settings;
+}
+
 svg::Color ParseColor(const json::Node& color_node) {
     if (color_node.IsString()) {
         return color_node.AsString();
@@ -2,6 +2,8 @@
 
 #include "request_handler.h"
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
+#include "catalogue_image.h"
 #include "map_renderer.h"
 #include "json.h"
 #include "json_builder.h"
@@ -11,36 +13,48 @@ namespace json_reader {
 
 class JsonReader {
 public:
-    JsonReader(TransportCatalog::Transport::TransportCatalogue& db, 
-               const RenderSettings& render_settings,
-               const TransportRouter& router);
+    JsonReader(const RenderSettings& render_settings, const TransportRouter& router);
     
     void ProcessRequests(const json::Document& doc);
     const json::Array& GetResponses() const;
 
 private:
-    TransportCatalog::Transport::TransportCatalogue& db_;
-    RequestHandler handler_;
+    // Перед обработкой запросов публикуется снимок справочника, по которому
+    // отвечает router_: Bus, Stop и Map читают тот же снимок, что и маршруты
+    TransportCatalog::Transport::SnapshotPublisher snapshots_;
     json::Array responses_;
     MapRenderer renderer_;
     const TransportRouter& router_;
 
-    void ProcessBaseRequests(const json::Array& base_requests);
     void ProcessStatRequests(const json::Array& stat_requests);
     
-    void AddStop(const json::Dict& stop_dict);
-    void AddBus(const json::Dict& bus_dict);
-    
-    void ProcessMapRequest(const json::Dict& request, json::Builder& response_builder);
-    void ProcessBusRequest(const json::Dict& request, json::Builder& response_builder);
-    void ProcessStopRequest(const json::Dict& request, json::Builder& response_builder);
-    void ProcessRouteRequest(const json::Dict& request, json::Builder& response_builder);
-    
-    std::vector<std::tuple<std::string, std::string, int>> distances_to_set_;
+    void ProcessMapRequest(const TransportCatalog::Transport::CatalogueSnapshot& db,
+                           const json::Dict& request, json::Builder& response_builder);
+    void ProcessBusRequest(const TransportCatalog::Transport::CatalogueSnapshot& db,
+                           const json::Dict& request, json::Builder& response_builder);
+    void ProcessStopRequest(const TransportCatalog::Transport::CatalogueSnapshot& db,
+                            const json::Dict& request, json::Builder& response_builder);
+    void ProcessMatrixRequest(const TransportCatalog::Transport::CatalogueSnapshot& db,
+                              const json::Dict& request, json::Builder& response_builder);
+    void ProcessIsochroneRequest(const TransportCatalog::Transport::CatalogueSnapshot& db,
+                                 const json::Dict& request, json::Builder& response_builder);
 };
 
+// Ответы на запросы статистики по бинарному образу справочника
+json::Array ProcessStatRequests(const TransportCatalog::Transport::CatalogueImage& image, const json::Array& stat_requests);
+// SVG-карта всех автобусов снимка
+std::string RenderMap(const MapRenderer& renderer, const TransportCatalog::Transport::CatalogueSnapshot& db);
+
 void FillTransportCatalogue(TransportCatalog::Transport::TransportCatalogue& catalog, const json::Array& base_requests);
+// Применяет к заполненному справочнику и построенному по нему маршрутизатору
+// пакет изменений {"base_requests": [...], "routing_settings": {...}}, оба
+// ключа необязательны. Новые остановки и автобусы добавляются, у известных
+// остановок меняются только расстояния. Маршрутизатор получает снимок
+// справочника после всех правок, граф обновляется без перестроения.
+void ApplyUpdates(TransportCatalog::Transport::TransportCatalogue& catalog, TransportRouter& router,
+                  const json::Dict& updates);
 RenderSettings ParseRenderSettings(const json::Dict& render_settings);
+RoutingSettings ParseRoutingSettings(const json::Dict& routing_settings);
 svg::Color ParseColor(const json::Node& color_node);
 
 } //namespace json_reader
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace graph {
+
+// Предрасчёт для поиска ALT (A*, landmarks, triangle inequality).
+// Для k опорных вершин L хранятся веса d(L, v) и d(v, L) до всех вершин
+// графа — 2 * k * V чисел float. По неравенству треугольника
+//     d(v, t) >= d(L, t) - d(L, v)  и  d(v, t) >= d(v, L) - d(t, L),
+// максимум этих разностей по всем L — допустимая нижняя оценка d(v, t).
+template <typename Weight>
+class LandmarkBounds {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    // Опорные вершины выбираются среди candidates: каждая следующая —
+    // самая удалённая от уже выбранных
+    LandmarkBounds(const Graph& graph, const std::vector<VertexId>& candidates, size_t landmark_count);
+
+    // Оценка веса пути до фиксированной цели; веса цели до опорных вершин
+    // выбираются один раз при создании
+    class Potential {
+    public:
+        Potential(const LandmarkBounds& bounds, VertexId target);
+        Weight operator()(VertexId vertex) const;
+
+    private:
+        const LandmarkBounds& bounds_;
+        std::vector<float> from_landmarks_;  // d(L, target)
+        std::vector<float> to_landmarks_;    // d(target, L)
+    };
+
+    Potential MakePotential(VertexId target) const {
+        return Potential(*this, target);
+    }
+
+    const std::vector<VertexId>& GetLandmarks() const {
+        return landmarks_;
+    }
+
+    size_t GetMemoryUsage() const {
+        return (from_landmarks_.capacity() + to_landmarks_.capacity()) * sizeof(float);
+    }
+
+private:
+    static constexpr float INFINITE_WEIGHT = std::numeric_limits<float>::infinity();
+    // Относительный запас на округление весов до float, чтобы оценка
+    // оставалась допустимой
+    static constexpr double ROUNDING_SLACK = 1e-6;
+
+    static void StoreTree(const ShortestPathTree<Weight>& tree, size_t landmark_count, size_t landmark_index,
+                          std::vector<float>& storage);
+
+    size_t vertex_count_;
+    std::vector<VertexId> landmarks_;
+    // Хранятся по вершинам: веса вершины v до всех опорных вершин подряд
+    std::vector<float> from_landmarks_;  // [v * k + i] = d(L_i, v)
+    std::vector<float> to_landmarks_;    // [v * k + i] = d(v, L_i)
+};
+
+template <typename Weight>
+LandmarkBounds<Weight>::LandmarkBounds(const Graph& graph, const std::vector<VertexId>& candidates,
+                                       size_t landmark_count)
+    : vertex_count_(graph.GetVertexCount())
+{
+    landmark_count = std::min(landmark_count, candidates.size());
+    if (landmark_count == 0) {
+        return;
+    }
+
+    const DijkstraRouter<Weight> forward_router(graph, CsrDirection::OUTGOING);
+    const DijkstraRouter<Weight> backward_router(graph, CsrDirection::INCOMING);
+
+    // Первая опорная вершина — самый удалённый от первого кандидата,
+    // каждая следующая — с наибольшим весом пути от ближайшей из выбранных.
+    // Недостижимые от выбранных кандидаты берутся в первую очередь, чтобы
+    // покрыть все компоненты связности.
+    VertexId next = candidates.front();
+    {
+        const auto seed_tree = forward_router.BuildShortestPathTree(next);
+        Weight farthest{};
+        for (const VertexId vertex : candidates) {
+            if (seed_tree.IsReachable(vertex) && farthest < seed_tree.weights[vertex]) {
+                farthest = seed_tree.weights[vertex];
+                next = vertex;
+            }
+        }
+    }
+
+    std::vector<ShortestPathTree<Weight>> forward_trees;
+    std::vector<double> nearest(vertex_count_, std::numeric_limits<double>::infinity());
+    std::vector<bool> is_landmark(vertex_count_, false);
+    while (true) {
+        landmarks_.push_back(next);
+        is_landmark[next] = true;
+        forward_trees.push_back(forward_router.BuildShortestPathTree(next));
+        if (landmarks_.size() == landmark_count) {
+            break;
+        }
+
+        const auto& tree = forward_trees.back();
+        double farthest = -1.0;
+        for (const VertexId vertex : candidates) {
+            if (tree.IsReachable(vertex)) {
+                nearest[vertex] = std::min<double>(nearest[vertex], tree.weights[vertex]);
+            }
+            if (!is_landmark[vertex] && nearest[vertex] > farthest) {
+                farthest = nearest[vertex];
+                next = vertex;
+            }
+        }
+        if (farthest < 0) {
+            break;
+        }
+    }
+
+    const size_t k = landmarks_.size();
+    from_landmarks_.assign(vertex_count_ * k, INFINITE_WEIGHT);
+    to_landmarks_.assign(vertex_count_ * k, INFINITE_WEIGHT);
+    for (size_t i = 0; i < k; ++i) {
+        StoreTree(forward_trees[i], k, i, from_landmarks_);
+    }
+    forward_trees.clear();
+
+    // Обратные поиски независимы и выполняются параллельно
+    parallel::ForEachIndex(k, [&](size_t i) {
+        StoreTree(backward_router.BuildShortestPathTree(landmarks_[i]), k, i, to_landmarks_);
+    });
+}
+
+template <typename Weight>
+void LandmarkBounds<Weight>::StoreTree(const ShortestPathTree<Weight>& tree, size_t landmark_count,
+                                       size_t landmark_index, std::vector<float>& storage) {
+    for (VertexId vertex = 0; vertex < tree.weights.size(); ++vertex) {
+        if (tree.IsReachable(vertex)) {
+            storage[vertex * landmark_count + landmark_index] = static_cast<float>(tree.weights[vertex]);
+        }
+    }
+}
+
+template <typename Weight>
+LandmarkBounds<Weight>::Potential::Potential(const LandmarkBounds& bounds, VertexId target)
+    : bounds_(bounds)
+{
+    if (target >= bounds.vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const size_t k = bounds.landmarks_.size();
+    from_landmarks_.assign(bounds.from_landmarks_.begin() + target * k,
+                           bounds.from_landmarks_.begin() + (target + 1) * k);
+    to_landmarks_.assign(bounds.to_landmarks_.begin() + target * k,
+                         bounds.to_landmarks_.begin() + (target + 1) * k);
+}
+
+template <typename Weight>
+Weight LandmarkBounds<Weight>::Potential::operator()(VertexId vertex) const {
+    const size_t k = from_landmarks_.size();
+    const float* vertex_from = bounds_.from_landmarks_.data() + vertex * k;
+    const float* vertex_to = bounds_.to_landmarks_.data() + vertex * k;
+
+    double bound = 0.0;
+    for (size_t i = 0; i < k; ++i) {
+        // Бесконечные веса не дают оценки: пропускаем их
+        if (from_landmarks_[i] != INFINITE_WEIGHT && vertex_from[i] != INFINITE_WEIGHT) {
+            const double target_weight = from_landmarks_[i];
+            const double vertex_weight = vertex_from[i];
+            bound = std::max(bound, target_weight - vertex_weight - (target_weight + vertex_weight) * ROUNDING_SLACK);
+        }
+        if (vertex_to[i] != INFINITE_WEIGHT && to_landmarks_[i] != INFINITE_WEIGHT) {
+            const double vertex_weight = vertex_to[i];
+            const double target_weight = to_landmarks_[i];
+            bound = std::max(bound, vertex_weight - target_weight - (vertex_weight + target_weight) * ROUNDING_SLACK);
+        }
+    }
+    return static_cast<Weight>(bound);
+}
+
+}  // namespace graph
@@ -1,37 +1,135 @@
 #include "json.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
+#include "catalogue_image.h"
 #include "json_reader.h"
 
 #include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 using namespace std;
 
-int main() {
+namespace {
+
+// Образ хранит только граф без сжатых цепочек, и маршруты по нему ищет
+// поиск Дейкстры без предрасчёта, эвристик, кэша и целых весов. На ответы
+// эти параметры не влияют, кроме округления при fixed_point_weights, поэтому
+// make_base строит образ без них и сообщает о каждом заданном в std::cerr.
+RoutingSettings MakeImageSettings(const RoutingSettings& settings) {
+    std::vector<std::string_view> ignored;
+    if (settings.strategy != RoutingSettings::Strategy::AUTO
+        && settings.strategy != RoutingSettings::Strategy::DIJKSTRA) {
+        ignored.push_back("strategy");
+    }
+    if (settings.heuristic != RoutingSettings::Heuristic::NONE) {
+        ignored.push_back("heuristic");
+    }
+    if (settings.compress_chains) {
+        ignored.push_back("compress_chains");
+    }
+    if (settings.fixed_point_weights) {
+        ignored.push_back("fixed_point_weights");
+    }
+    if (settings.tree_cache_bytes != 0) {
+        ignored.push_back("tree_cache_mb");
+    }
+    for (const string_view name : ignored) {
+        cerr << "make_base: routing setting " << name << " is not supported by the catalogue image, ignored" << endl;
+    }
+
+    RoutingSettings graph_settings;
+    graph_settings.bus_wait_time = settings.bus_wait_time;
+    graph_settings.bus_velocity = settings.bus_velocity;
+    graph_settings.graph_model = settings.graph_model;
+    graph_settings.prune_parallel_edges = settings.prune_parallel_edges;
+    graph_settings.log_stats = settings.log_stats;
+    graph_settings.strategy = RoutingSettings::Strategy::DIJKSTRA;
+    return graph_settings;
+}
+
+// Строит справочник и граф маршрутов и сохраняет их вместе с картой в файл
+// serialization_settings.file
+void MakeBase(const json::Dict& input) {
+    TransportCatalog::Transport::TransportCatalogue catalogue;
+    json_reader::FillTransportCatalogue(catalogue, input.at("base_requests").AsArray());
+
+    TransportRouter router(catalogue,
+                           MakeImageSettings(json_reader::ParseRoutingSettings(input.at("routing_settings").AsDict())));
+    if (input.count("updates")) {
+        // Новые параметры маршрутизации приводятся к виду для образа так же
+        json::Dict updates = input.at("updates").AsDict();
+        std::optional<RoutingSettings> new_settings;
+        if (const auto it = updates.find("routing_settings"); it != updates.end()) {
+            new_settings = json_reader::ParseRoutingSettings(it->second.AsDict());
+            updates.erase(it);
+        }
+        json_reader::ApplyUpdates(catalogue, router, updates);
+        if (new_settings) {
+            router.UpdateSettings(MakeImageSettings(*new_settings));
+        }
+    }
+
+    const auto& snapshot = router.GetCatalogue();
+    const MapRenderer renderer(json_reader::ParseRenderSettings(input.at("render_settings").AsDict()));
+    TransportCatalog::Transport::CatalogueImage::Write(
+        input.at("serialization_settings").AsDict().at("file").AsString(), *snapshot, router,
+        json_reader::RenderMap(renderer, *snapshot));
+}
+
+// Отвечает на stat_requests по образу из serialization_settings.file
+void ProcessRequests(const json::Dict& input) {
+    const TransportCatalog::Transport::CatalogueImage image(
+        input.at("serialization_settings").AsDict().at("file").AsString());
+    json::Print(json::Document(json_reader::ProcessStatRequests(image, input.at("stat_requests").AsArray())), cout);
+}
+
+} // namespace
+
+// Без аргументов справочник строится и отвечает на запросы за один запуск.
+// make_base сохраняет бинарный образ, process_requests отвечает по нему.
+int main(int argc, char* argv[]) {
+    const string_view mode = argc > 1 ? argv[1] : "";
+    if (mode != "" && mode != "make_base" && mode != "process_requests") {
+        cerr << "Usage: transport_catalogue [make_base|process_requests]" << endl;
+        return 1;
+    }
+
     json::Document doc = json::Load(cin);
     const auto& input = doc.GetRoot().AsDict();
 
+    if (mode == "make_base") {
+        MakeBase(input);
+        return 0;
+    }
+    if (mode == "process_requests") {
+        ProcessRequests(input);
+        return 0;
+    }
+
     TransportCatalog::Transport::TransportCatalogue catalogue;
     json_reader::FillTransportCatalogue(catalogue, input.at("base_requests").AsArray());
 
     const auto& routing_settings = input.at("routing_settings").AsDict();
-    int bus_wait_time = routing_settings.at("bus_wait_time").AsInt();
-    double bus_velocity = routing_settings.at("bus_velocity").AsDouble();
-
-    TransportRouter router(catalogue, bus_wait_time, bus_velocity);
+    TransportRouter router(catalogue, json_reader::ParseRoutingSettings(routing_settings));
+    if (input.count("updates")) {
+        json_reader::ApplyUpdates(catalogue, router, input.at("updates").AsDict());
+    }
 
     const auto& render_settings = input.at("render_settings").AsDict();
     RenderSettings settings = json_reader::ParseRenderSettings(render_settings);
 
     // Создаем JsonReader с настройками рендеринга и маршрутизатором:
-    json_reader::JsonReader reader(catalogue, settings, router);
+    json_reader::JsonReader reader(settings, router);
 
     // Обрабатываем запросы:
     reader.ProcessRequests(doc);
 
     // Выводим ответы в JSON:
     json::Print(json::Document(reader.GetResponses()), cout);
+    router.LogQueryStats();
 
     return 0;
 }
\ No newline at end of file
@@ -5,10 +5,11 @@
 MapRenderer::MapRenderer(const RenderSettings& settings) : settings_(settings) {}
 
 // Основной метод RenderMap
-svg::Document MapRenderer::RenderMap(const std::vector<const Domain::Bus*>& buses) const {
+svg::Document MapRenderer::RenderMap(const std::vector<const Domain::Bus*>& buses,
+                                     const TransportCatalog::Transport::CatalogueSnapshot& db) const {
     svg::Document doc;
 
-    const auto unique_stops = GetUniqueStops(buses);
+    const auto unique_stops = GetUniqueStops(buses, db);
     const auto all_coords = GetAllCoordinates(unique_stops);
     const auto projector = CreateProjector(all_coords);
 
@@ -17,8 +18,8 @@ svg::Document MapRenderer::RenderMap(const std::vector<const Domain::Bus*>& buse
         return lhs->name < rhs->name;
     });
 
-    RenderBusLines(doc, sorted_buses, projector);
-    RenderBusLabels(doc, sorted_buses, projector);
+    RenderBusLines(doc, sorted_buses, db, projector);
+    RenderBusLabels(doc, sorted_buses, db, projector);
 
     std::vector<const Domain::Stop*> sorted_stops(unique_stops.begin(), unique_stops.end());
     std::sort(sorted_stops.begin(), sorted_stops.end(), [](const Domain::Stop* lhs, const Domain::Stop* rhs) {
@@ -32,12 +33,18 @@ svg::Document MapRenderer::RenderMap(const std::vector<const Domain::Bus*>& buse
 }
 
 // Получение уникальных остановок
-std::vector<const Domain::Stop*> MapRenderer::GetUniqueStops(const std::vector<const Domain::Bus*>& buses) const {
-    std::set<const Domain::Stop*> unique_stops;
+std::vector<const Domain::Stop*> MapRenderer::GetUniqueStops(const std::vector<const Domain::Bus*>& buses,
+                                                             const TransportCatalog::Transport::CatalogueSnapshot& db) const {
+    std::set<Domain::StopId> unique_stops;
     for (const auto& bus : buses) {
         unique_stops.insert(bus->stops.begin(), bus->stops.end());
     }
-    return {unique_stops.begin(), unique_stops.end()};
+    std::vector<const Domain::Stop*> stops;
+    stops.reserve(unique_stops.size());
+    for (const Domain::StopId stop : unique_stops) {
+        stops.push_back(&db.GetStop(stop));
+    }
+    return stops;
 }
 
 // Получение координат всех остановок
@@ -55,7 +62,8 @@ SphereProjector MapRenderer::CreateProjector(const std::vector<Geo::Coordinates>
 }
 
 // Отрисовка линий маршрутов
-void MapRenderer::RenderBusLines(svg::Document& doc, const std::vector<const Domain::Bus*>& buses, const SphereProjector& projector) const {
+void MapRenderer::RenderBusLines(svg::Document& doc, const std::vector<const Domain::Bus*>& buses,
+                                 const TransportCatalog::Transport::CatalogueSnapshot& db, const SphereProjector& projector) const {
     std::vector<const Domain::Bus*> sorted_buses = buses;
     std::sort(sorted_buses.begin(), sorted_buses.end(), [](const Domain::Bus* lhs, const Domain::Bus* rhs) {
         return lhs->name < rhs->name;
@@ -66,12 +74,12 @@ void MapRenderer::RenderBusLines(svg::Document& doc, const std::vector<const Dom
         if (bus->stops.empty()) continue;
 
         svg::Polyline line;
-        for (const auto& stop : bus->stops) {
-            line.AddPoint(projector(stop->coordinates));
+        for (const auto stop : bus->stops) {
+            line.AddPoint(projector(db.GetStop(stop).coordinates));
         }
         if (!bus->is_circular) {
             for (auto it = std::next(bus->stops.rbegin()); it != bus->stops.rend(); ++it) {
-                line.AddPoint(projector((*it)->coordinates));
+                line.AddPoint(projector(db.GetStop(*it).coordinates));
             }
         }
 
@@ -88,15 +96,16 @@ void MapRenderer::RenderBusLines(svg::Document& doc, const std::vector<const Dom
 }
 
 // Отрисовка названий маршрутов
-void MapRenderer::RenderBusLabels(svg::Document& doc, const std::vector<const Domain::Bus*>& buses, const SphereProjector& projector) const {
+void MapRenderer::RenderBusLabels(svg::Document& doc, const std::vector<const Domain::Bus*>& buses,
+                                  const TransportCatalog::Transport::CatalogueSnapshot& db, const SphereProjector& projector) const {
     size_t color_index = 0; // Сбрасываем color_index перед отрисовкой названий
     for (const auto& bus : buses) {
         if (bus->stops.empty()) continue;
 
         std::vector<const Domain::Stop*> end_stops;
-        end_stops.push_back(bus->stops.front());
+        end_stops.push_back(&db.GetStop(bus->stops.front()));
         if (!bus->is_circular && bus->stops.front() != bus->stops.back()) {
-            end_stops.push_back(bus->stops.back());
+            end_stops.push_back(&db.GetStop(bus->stops.back()));
         }
 
         for (const auto& stop : end_stops) {
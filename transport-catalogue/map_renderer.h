@@ -3,13 +3,14 @@
 #include "svg.h"
 #include "geo.h"
 #include "domain.h"
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <unordered_set>
 #include <iostream>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -103,14 +104,18 @@ struct RenderSettings {
 class MapRenderer {
 public:
     MapRenderer(const RenderSettings& settings);
-    svg::Document RenderMap(const std::vector<const Domain::Bus*>& buses) const;
+    svg::Document RenderMap(const std::vector<const Domain::Bus*>& buses,
+                            const TransportCatalog::Transport::CatalogueSnapshot& db) const;
 
 private:
-    std::vector<const Domain::Stop*> GetUniqueStops(const std::vector<const Domain::Bus*>& buses) const;
+    std::vector<const Domain::Stop*> GetUniqueStops(const std::vector<const Domain::Bus*>& buses,
+                                                    const TransportCatalog::Transport::CatalogueSnapshot& db) const;
     std::vector<Geo::Coordinates> GetAllCoordinates(const std::vector<const Domain::Stop*>& stops) const;
     SphereProjector CreateProjector(const std::vector<Geo::Coordinates>& all_coords) const;
-    void RenderBusLines(svg::Document& doc, const std::vector<const Domain::Bus*>& buses, const SphereProjector& projector) const;
-    void RenderBusLabels(svg::Document& doc, const std::vector<const Domain::Bus*>& buses, const SphereProjector& projector) const;
+    void RenderBusLines(svg::Document& doc, const std::vector<const Domain::Bus*>& buses,
+                        const TransportCatalog::Transport::CatalogueSnapshot& db, const SphereProjector& projector) const;
+    void RenderBusLabels(svg::Document& doc, const std::vector<const Domain::Bus*>& buses,
+                         const TransportCatalog::Transport::CatalogueSnapshot& db, const SphereProjector& projector) const;
     void RenderStopSymbols(svg::Document& doc, const std::vector<const Domain::Stop*>& stops, const SphereProjector& projector) const;
     void RenderStopLabels(svg::Document& doc, const std::vector<const Domain::Stop*>& stops, const SphereProjector& projector) const;
     RenderSettings settings_;
@@ -0,0 +1,93 @@
+#include "parallel.h"
+
+namespace parallel {
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this] {
+            WorkerLoop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(mutex_);
+        stopping_ = true;
+    }
+    task_added_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::RunIndices(Task& task) {
+    for (size_t index = task.next_index++; index < task.count; index = task.next_index++) {
+        try {
+            task.func(index);
+        } catch (...) {
+            std::lock_guard guard(task.error_mutex);
+            if (!task.error) {
+                task.error = std::current_exception();
+            }
+            task.next_index = task.count;
+        }
+    }
+}
+
+// Задача живёт на стеке вызывающего потока, поэтому он выходит только
+// после того, как её покинут все рабочие потоки
+void ThreadPool::RunTask(Task& task) {
+    {
+        std::lock_guard guard(mutex_);
+        tasks_.push_back(&task);
+        task.participants = 1;
+    }
+    task_added_.notify_all();
+
+    RunIndices(task);
+
+    std::unique_lock lock(mutex_);
+    RemoveTask(&task);
+    --task.participants;
+    task_finished_.wait(lock, [&task] {
+        return task.participants == 0;
+    });
+    lock.unlock();
+    if (task.error) {
+        std::rethrow_exception(task.error);
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        task_added_.wait(lock, [this] {
+            return stopping_ || !tasks_.empty();
+        });
+        if (tasks_.empty()) {
+            return;
+        }
+        Task* task = tasks_.front();
+        ++task->participants;
+        lock.unlock();
+
+        RunIndices(*task);
+
+        lock.lock();
+        // Все индексы розданы: новым потокам к задаче подключаться незачем
+        RemoveTask(task);
+        if (--task->participants == 0) {
+            task_finished_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::RemoveTask(Task* task) {
+    const auto it = std::find(tasks_.begin(), tasks_.end(), task);
+    if (it != tasks_.end()) {
+        tasks_.erase(it);
+    }
+}
+
+}  // namespace parallel
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// Число рабочих потоков по умолчанию
+inline size_t GetDefaultThreadCount() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Вызывает func(index) для каждого index из [0, count). Индексы раздаются
+// потокам по одному, поэтому задачи разной длины распределяются равномерно.
+// Первое выброшенное исключение пробрасывается вызывающему после
+// завершения всех потоков.
+//
+// Потоки создаются на каждый вызов. Это годится для предрасчёта, где
+// вызовов немного и каждый делает большую работу (раунды иерархии сжатия,
+// строки таблицы всех пар); для частых коротких вызовов есть ThreadPool.
+template <typename Func>
+void ForEachIndex(size_t count, Func func, size_t thread_count = GetDefaultThreadCount()) {
+    thread_count = std::min(thread_count, count);
+    if (thread_count <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            func(index);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_index{0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&] {
+        for (size_t index = next_index++; index < count; index = next_index++) {
+            try {
+                func(index);
+            } catch (...) {
+                std::lock_guard guard(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_index = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// Постоянные рабочие потоки для частых вызовов ForEachIndex: запуск потоков
+// не повторяется на каждый пакет запросов. Вызывающий поток сам обрабатывает
+// индексы своего вызова, а свободные рабочие потоки подключаются к нему.
+// Поэтому вызовы из нескольких потоков сразу и вложенные вызовы из func
+// не ждут освобождения пула и не взаимоблокируются.
+class ThreadPool {
+public:
+    // thread_count учитывает вызывающий поток: рабочих потоков на один меньше
+    explicit ThreadPool(size_t thread_count = GetDefaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t GetThreadCount() const {
+        return workers_.size() + 1;
+    }
+
+    // То же, что parallel::ForEachIndex, но на потоках пула
+    template <typename Func>
+    void ForEachIndex(size_t count, Func func);
+
+private:
+    struct Task {
+        std::function<void(size_t)> func;
+        size_t count;
+        std::atomic<size_t> next_index{0};
+        // Потоки, обрабатывающие задачу; защищено mutex_
+        size_t participants = 0;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+    };
+
+    static void RunIndices(Task& task);
+    void RunTask(Task& task);
+    void WorkerLoop();
+    // Убирает задачу из очереди, если она ещё там; вызывается под mutex_
+    void RemoveTask(Task* task);
+
+    std::mutex mutex_;
+    std::condition_variable task_added_;
+    std::condition_variable task_finished_;
+    // Задачи, индексы которых ещё могут быть не розданы
+    std::deque<Task*> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+template <typename Func>
+void ThreadPool::ForEachIndex(size_t count, Func func) {
+    if (workers_.empty() || count <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            func(index);
+        }
+        return;
+    }
+    Task task;
+    task.func = std::ref(func);
+    task.count = count;
+    RunTask(task);
+}
+
+}  // namespace parallel
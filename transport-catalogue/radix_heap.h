@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Монотонная очередь с приоритетом для целых беззнаковых ключей (радикс-куча).
+// Ключ новой записи не может быть меньше ключа последней извлечённой — это
+// выполняется в алгоритме Дейкстры с неотрицательными весами. Запись лежит
+// в корзине по старшему биту, которым её ключ отличается от последнего
+// извлечённого, поэтому вставка стоит O(1), а каждая запись за время жизни
+// перекладывается не более чем число бит ключа раз.
+template <typename Key, typename Value>
+class RadixHeap {
+    static_assert(std::is_unsigned_v<Key>, "RadixHeap requires an unsigned key");
+
+public:
+    using Entry = std::pair<Key, Value>;
+
+    bool IsEmpty() const {
+        return size_ == 0;
+    }
+
+    void Clear() {
+        for (auto& bucket : buckets_) {
+            bucket.clear();
+        }
+        size_ = 0;
+        last_key_ = 0;
+    }
+
+    void Push(Key key, Value value) {
+        if (key < last_key_) {
+            throw std::invalid_argument("Key is less than the last popped key");
+        }
+        buckets_[GetBucket(key)].emplace_back(key, value);
+        ++size_;
+    }
+
+    // Извлекает запись с наименьшим ключом; при равных ключах порядок не определён
+    Entry Pop() {
+        if (buckets_[0].empty()) {
+            size_t index = 1;
+            while (buckets_[index].empty()) {
+                ++index;
+            }
+            // Наименьший ключ корзины становится последним извлечённым; остальные
+            // записи корзины отличаются от него в младших битах и опускаются ниже
+            auto& bucket = buckets_[index];
+            last_key_ = bucket.front().first;
+            for (const auto& entry : bucket) {
+                last_key_ = std::min(last_key_, entry.first);
+            }
+            for (const auto& entry : bucket) {
+                buckets_[GetBucket(entry.first)].push_back(entry);
+            }
+            bucket.clear();
+        }
+        Entry entry = buckets_[0].back();
+        buckets_[0].pop_back();
+        --size_;
+        return entry;
+    }
+
+private:
+    static constexpr size_t KEY_BITS = std::numeric_limits<Key>::digits;
+
+    // 0 — ключ равен последнему извлечённому, иначе 1 + номер старшего
+    // отличающегося бита
+    size_t GetBucket(Key key) const {
+        Key diff = key ^ last_key_;
+        size_t bucket = 0;
+        for (size_t shift = KEY_BITS / 2; shift > 0; shift /= 2) {
+            if ((diff >> shift) != 0) {
+                diff >>= shift;
+                bucket += shift;
+            }
+        }
+        return bucket + static_cast<size_t>(diff);
+    }
+
+    std::vector<Entry> buckets_[KEY_BITS + 1];
+    size_t size_ = 0;
+    Key last_key_ = 0;
+};
+
+}  // namespace graph
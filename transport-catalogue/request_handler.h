@@ -1,15 +1,16 @@
 #pragma once
 
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include <optional>
+#include <string>
 
 class RequestHandler {
 public:
-    RequestHandler(const TransportCatalog::Transport::TransportCatalogue& db);
+    RequestHandler(const TransportCatalog::Transport::CatalogueSnapshot& db);
 
     std::optional<const Domain::BusInfo> GetBusStat(const std::string& bus_name) const;
-    std::optional<const std::set<std::string_view>> GetStopInfo(const std::string& stop_name) const;
+    std::optional<const TransportCatalog::Transport::CatalogueSnapshot::BusNames> GetStopInfo(const std::string& stop_name) const;
 
 private:
-    const TransportCatalog::Transport::TransportCatalogue& db_;
+    const TransportCatalog::Transport::CatalogueSnapshot& db_;
 };
\ No newline at end of file
@@ -29,6 +29,9 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // Вес кратчайшего пути без восстановления списка рёбер
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -94,6 +97,15 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
+template <typename Weight>
+std::optional<Weight> Router<Weight>::GetRouteWeight(VertexId from, VertexId to) const {
+    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+    if (!route_internal_data) {
+        return std::nullopt;
+    }
+    return route_internal_data->weight;
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "dijkstra_router.h"
+
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace graph {
+
+// Потокобезопасный LRU-кэш деревьев кратчайших путей с ограничением по памяти.
+// Деревья отдаются через shared_ptr, поэтому вытеснение не затрагивает
+// запросы, которые ещё читают дерево.
+template <typename Weight>
+class ShortestPathTreeCache {
+public:
+    using Tree = ShortestPathTree<Weight>;
+    using TreePtr = std::shared_ptr<const Tree>;
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes_used = 0;
+        size_t bytes_limit = 0;
+    };
+
+    explicit ShortestPathTreeCache(size_t bytes_limit);
+
+    // Возвращает дерево с корнем root или nullptr, если его нет в кэше
+    TreePtr Find(VertexId root);
+
+    // Добавляет дерево, вытесняя давно не использованные. Дерево,
+    // которое само не помещается в лимит, не сохраняется.
+    void Insert(TreePtr tree);
+
+    // Удаляет деревья, для которых predicate(tree) истинен; возвращает их число
+    template <typename Predicate>
+    size_t EraseIf(Predicate predicate);
+
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        TreePtr tree;
+        size_t bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    mutable std::mutex mutex_;
+    EntryList entries_;  // от недавно использованных к давно не использованным
+    std::unordered_map<VertexId, typename EntryList::iterator> root_to_entry_;
+    Stats stats_;
+};
+
+template <typename Weight>
+ShortestPathTreeCache<Weight>::ShortestPathTreeCache(size_t bytes_limit) {
+    stats_.bytes_limit = bytes_limit;
+}
+
+template <typename Weight>
+typename ShortestPathTreeCache<Weight>::TreePtr ShortestPathTreeCache<Weight>::Find(VertexId root) {
+    std::lock_guard guard(mutex_);
+    const auto it = root_to_entry_.find(root);
+    if (it == root_to_entry_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->tree;
+}
+
+template <typename Weight>
+void ShortestPathTreeCache<Weight>::Insert(TreePtr tree) {
+    const size_t bytes = tree->GetMemoryUsage();
+    std::lock_guard guard(mutex_);
+    if (bytes > stats_.bytes_limit || root_to_entry_.count(tree->root)) {
+        return;
+    }
+    while (stats_.bytes_used + bytes > stats_.bytes_limit) {
+        const Entry& victim = entries_.back();
+        stats_.bytes_used -= victim.bytes;
+        root_to_entry_.erase(victim.tree->root);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+    const VertexId root = tree->root;
+    entries_.push_front({std::move(tree), bytes});
+    root_to_entry_[root] = entries_.begin();
+    stats_.bytes_used += bytes;
+}
+
+template <typename Weight>
+template <typename Predicate>
+size_t ShortestPathTreeCache<Weight>::EraseIf(Predicate predicate) {
+    std::lock_guard guard(mutex_);
+    size_t erased = 0;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (!predicate(*it->tree)) {
+            ++it;
+            continue;
+        }
+        stats_.bytes_used -= it->bytes;
+        root_to_entry_.erase(it->tree->root);
+        it = entries_.erase(it);
+        ++erased;
+    }
+    return erased;
+}
+
+template <typename Weight>
+typename ShortestPathTreeCache<Weight>::Stats ShortestPathTreeCache<Weight>::GetStats() const {
+    std::lock_guard guard(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
+
+}  // namespace graph
@@ -0,0 +1,97 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "all_pairs_table.h"
+#include "graph.h"
+#include "router.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using graph::AllPairsTable;
+using graph::DirectedWeightedGraph;
+using graph::EdgeWeightChange;
+using graph::Router;
+using graph::VertexId;
+
+namespace {
+
+// Таблица даёт те же веса, что и Router, для всех пар вершин, а маршруты
+// складываются из рёбер графа. Веса графа целые и небольшие, поэтому
+// округление до float их не меняет.
+void AssertSameRoutes(const DirectedWeightedGraph<double>& graph, const AllPairsTable<double>& table) {
+    const Router<double> router(graph);
+    for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+            const auto expected = router.GetRouteWeight(from, to);
+            const auto weight = table.GetRouteWeight(from, to);
+            const auto route = table.BuildRoute(from, to);
+            ASSERT_EQUAL_HINT(weight.has_value(), expected.has_value(), pair);
+            ASSERT_EQUAL_HINT(route.has_value(), expected.has_value(), pair);
+            if (expected) {
+                ASSERT_EQUAL_HINT(*weight, *expected, pair);
+                ASSERT_EQUAL_HINT(route->weight, *expected, pair);
+                tests::AssertRouteEdges(graph, from, to, route->edges, route->weight);
+            }
+        }
+    }
+}
+
+void TestMatchesRouter() {
+    for (const uint32_t seed : {1u, 2u, 3u}) {
+        // Разреженный граф с недостижимыми вершинами и плотный
+        for (const size_t edge_count : {60u, 400u}) {
+            const auto graph = tests::GenerateGraph(seed, 50, edge_count);
+            AssertSameRoutes(graph, AllPairsTable<double>(graph));
+            // Результат не зависит от числа потоков
+            AssertSameRoutes(graph, AllPairsTable<double>(graph, 1));
+        }
+    }
+}
+
+// После изменения весов пересчитываются только устаревшие строки, и
+// таблица совпадает с построенной заново
+void TestUpdate() {
+    auto graph = tests::GenerateGraph(4, 50, 300);
+    AllPairsTable<double> table(graph);
+    ASSERT_EQUAL(table.Update({}), 0u);
+
+    // Удорожание ребра, не лежащего ни на одном кратчайшем пути, строк не трогает
+    const graph::EdgeId loop = graph.AddEdge({0, 0, 5});
+    AllPairsTable<double> loop_table(graph);
+    graph.SetEdgeWeight(loop, 7);
+    ASSERT_EQUAL(loop_table.Update({{loop, 5}}), 0u);
+    AssertSameRoutes(graph, loop_table);
+
+    std::vector<EdgeWeightChange<double>> changes;
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); edge_id += 7) {
+        changes.push_back({edge_id, graph.GetEdge(edge_id).weight});
+        graph.SetEdgeWeight(edge_id, edge_id % 2 ? 0 : graph.GetEdge(edge_id).weight * 3 + 1);
+    }
+    const size_t updated_rows = loop_table.Update(changes);
+    ASSERT(updated_rows > 0);
+    AssertSameRoutes(graph, loop_table);
+}
+
+void TestOutOfRangeThrows() {
+    const auto graph = tests::GenerateGraph(5, 10, 30);
+    const AllPairsTable<double> table(graph);
+    bool thrown = false;
+    try {
+        table.GetRouteWeight(0, 10);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+} // namespace
+
+void TestAllPairsTable() {
+    RUN_TEST(TestMatchesRouter);
+    RUN_TEST(TestUpdate);
+    RUN_TEST(TestOutOfRangeThrows);
+}
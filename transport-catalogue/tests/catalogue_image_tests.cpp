@@ -0,0 +1,224 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "catalogue_image.h"
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using TransportCatalog::Transport::CatalogueImage;
+using TransportCatalog::Transport::TransportCatalogue;
+
+namespace {
+
+// Файл во временном каталоге, удаляемый по выходе из теста
+class TemporaryFile {
+public:
+    explicit TemporaryFile(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() / name).string()) {
+    }
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    const std::string& GetPath() const {
+        return path_;
+    }
+
+private:
+    std::string path_;
+};
+
+RoutingSettings MakeImageSettings(RoutingSettings::GraphModel graph_model) {
+    RoutingSettings settings;
+    settings.bus_wait_time = 6;
+    settings.bus_velocity = 40;
+    settings.strategy = RoutingSettings::Strategy::DIJKSTRA;
+    settings.graph_model = graph_model;
+    return settings;
+}
+
+// Образ отвечает так же, как справочник и маршрутизатор, из которых записан
+void TestRoundTrip() {
+    const auto network = tests::GenerateNetwork(25, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    db.AddStop("Lonely", {55.6, 37.6});
+    const auto snapshot = db.Freeze();
+    const auto stops = tests::GetStopNames(db);
+    const std::string map_svg = "<svg>map</svg>";
+
+    for (const auto model : {RoutingSettings::GraphModel::PAIRWISE, RoutingSettings::GraphModel::COMPACT}) {
+        const TransportRouter router(db, MakeImageSettings(model));
+        const TemporaryFile file("transport_catalogue_image_test.bin");
+        CatalogueImage::Write(file.GetPath(), *snapshot, router, map_svg);
+        const CatalogueImage image(file.GetPath());
+
+        ASSERT_EQUAL(image.GetMap(), map_svg);
+        ASSERT(!image.FindStop("Unknown"));
+        ASSERT(!image.FindBus("Unknown"));
+        for (const auto& stop : db.GetAllStops()) {
+            ASSERT_EQUAL(*image.FindStop(stop.name), stop.id);
+            ASSERT_EQUAL(image.GetStopName(stop.id), stop.name);
+            const auto expected_buses = db.GetBusesByStop(stop.name);
+            const auto buses = image.GetBusNamesByStop(stop.id);
+            ASSERT(std::equal(buses.begin(), buses.end(), expected_buses.begin(), expected_buses.end()));
+            for (const auto& other : db.GetAllStops()) {
+                ASSERT_EQUAL(image.GetDistance(stop.id, other.id), db.GetDistance(stop.id, other.id));
+            }
+        }
+        for (const auto& bus : db.GetAllBuses()) {
+            ASSERT_EQUAL(*image.FindBus(bus.name), bus.id);
+            ASSERT_EQUAL(image.GetBusName(bus.id), bus.name);
+            const auto bus_stops = image.GetBusStops(bus.id);
+            ASSERT(std::equal(bus_stops.begin(), bus_stops.end(), bus.stops.begin(), bus.stops.end()));
+            const auto info = image.GetBusInfo(bus.id);
+            const auto expected = db.GetBusInfo(bus.name);
+            ASSERT_EQUAL(info.stops_on_route, expected.stops_on_route);
+            ASSERT_EQUAL(info.unique_stops, expected.unique_stops);
+            ASSERT_EQUAL(info.route_length, expected.route_length);
+            ASSERT_EQUAL(info.curvature, expected.curvature);
+        }
+
+        // Маршруты того же времени, составленные из поездок по справочнику
+        std::vector<std::pair<std::string_view, std::string_view>> requests;
+        for (const auto from : stops) {
+            for (const auto to : stops) {
+                requests.emplace_back(from, to);
+            }
+        }
+        const auto routes = image.BuildRoutes(requests);
+        const auto expected_times = tests::BuildAllTravelTimes(router, stops);
+        const auto times = image.BuildTravelTimeMatrix(stops, stops);
+        for (size_t index = 0; index < requests.size(); ++index) {
+            const auto& [from, to] = requests[index];
+            ASSERT_EQUAL(routes[index].has_value(), expected_times[index].has_value());
+            ASSERT_EQUAL(times[index].has_value(), expected_times[index].has_value());
+            if (expected_times[index]) {
+                ASSERT(IsNear(routes[index]->total_time, *expected_times[index]));
+                ASSERT(IsNear(*times[index], *expected_times[index]));
+                tests::AssertValidRoute(db, MakeImageSettings(model), from, to, *routes[index]);
+            }
+        }
+        for (const double max_time : {0.0, 15.0, 1000.0}) {
+            const auto reachable = image.FindReachableStops(stops[0], max_time);
+            const auto expected = router.FindReachableStops(stops[0], max_time);
+            ASSERT_EQUAL(reachable.size(), expected.size());
+            for (size_t k = 0; k < reachable.size(); ++k) {
+                ASSERT(IsNear(reachable[k].time, expected[k].time));
+            }
+        }
+    }
+}
+
+// Повреждённый, усечённый или чужой файл не открывается
+void TestCorruptImageThrows() {
+    TransportCatalogue db;
+    tests::LoadNetwork(db, tests::GenerateNetwork(26, 10, 3));
+    const TransportRouter router(db, MakeImageSettings(RoutingSettings::GraphModel::PAIRWISE));
+    const TemporaryFile file("transport_catalogue_image_corrupt_test.bin");
+    CatalogueImage::Write(file.GetPath(), *db.Freeze(), router, "<svg/>");
+    std::string original;
+    {
+        std::ifstream input(file.GetPath(), std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    ASSERT(original.size() > 64);
+
+    const auto assert_rejected = [&file](const std::string& content, const std::string& hint) {
+        {
+            std::ofstream output(file.GetPath(), std::ios::binary | std::ios::trunc);
+            output << content;
+        }
+        bool thrown = false;
+        try {
+            const CatalogueImage image(file.GetPath());
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT_HINT(thrown, hint);
+    };
+
+    // Заголовок: magic с 0, version с 8, таблица секций с 56 по 16 байт на
+    // секцию (offset, size); вторая секция — записи остановок, выровненные по 8
+    const auto patched = [&original](size_t offset, const void* value, size_t size) {
+        std::string content = original;
+        std::memcpy(content.data() + offset, value, size);
+        return content;
+    };
+    const uint32_t bad_version = TransportCatalog::Transport::CATALOGUE_IMAGE_VERSION + 1;
+    const uint64_t bad_offset = original.size() + 8;
+    const uint64_t odd_offset = 3;
+
+    assert_rejected("", "empty");
+    assert_rejected(original.substr(0, 32), "header only");
+    assert_rejected(original.substr(0, original.size() - 8), "truncated");
+    assert_rejected(original + std::string(8, '\0'), "extra bytes");
+    assert_rejected(patched(0, "XXXXXXXX", 8), "magic");
+    assert_rejected(patched(8, &bad_version, sizeof(bad_version)), "version");
+    assert_rejected(patched(56, &bad_offset, sizeof(bad_offset)), "section out of file");
+    assert_rejected(patched(56 + 16, &odd_offset, sizeof(odd_offset)), "misaligned section");
+
+    // Номера и смещения в первой записи секций: остановки (имя с 16), автобусы
+    // (имя с 0, остановки с 8), остановки автобусов, вершины остановок,
+    // смещения, цели, веса и автобусы дуг
+    const auto section_offset = [&original](size_t section) {
+        uint64_t offset = 0;
+        std::memcpy(&offset, original.data() + 56 + 16 * section, sizeof(offset));
+        return offset;
+    };
+    enum { STOPS = 1, BUSES = 3, BUS_STOPS = 5, STOP_VERTICES = 11, ARC_OFFSETS = 12, ARC_TARGETS = 13,
+           ARC_WEIGHTS = 14, ARC_BUSES = 15 };
+    const uint32_t huge = 1u << 30;
+    const uint64_t huge_vertex = uint64_t{1} << 40;
+    const double negative = -1.0;
+    assert_rejected(patched(section_offset(STOPS) + 16, &huge, sizeof(huge)), "stop name offset");
+    assert_rejected(patched(section_offset(STOPS) + 20, &huge, sizeof(huge)), "stop name size");
+    assert_rejected(patched(section_offset(BUSES), &huge, sizeof(huge)), "bus name offset");
+    assert_rejected(patched(section_offset(BUSES) + 8, &huge, sizeof(huge)), "bus first stop");
+    assert_rejected(patched(section_offset(BUSES) + 12, &huge, sizeof(huge)), "bus stop count");
+    assert_rejected(patched(section_offset(BUS_STOPS), &huge, sizeof(huge)), "bus stop id");
+    assert_rejected(patched(section_offset(STOP_VERTICES), &huge, sizeof(huge)), "stop vertex");
+    assert_rejected(patched(section_offset(ARC_OFFSETS) + 8, &huge_vertex, sizeof(huge_vertex)), "arc offset");
+    assert_rejected(patched(section_offset(ARC_TARGETS), &huge_vertex, sizeof(huge_vertex)), "arc target");
+    assert_rejected(patched(section_offset(ARC_WEIGHTS), &negative, sizeof(negative)), "arc weight");
+    assert_rejected(patched(section_offset(ARC_BUSES), &huge, sizeof(huge)), "arc bus");
+
+    // Несуществующий файл
+    std::filesystem::remove(file.GetPath());
+    bool thrown = false;
+    try {
+        const CatalogueImage image(file.GetPath());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    // Исходный образ по-прежнему открывается
+    {
+        std::ofstream output(file.GetPath(), std::ios::binary | std::ios::trunc);
+        output << original;
+    }
+    const CatalogueImage image(file.GetPath());
+    ASSERT(image.FindStop("S0"));
+}
+
+} // namespace
+
+void TestCatalogueImage() {
+    RUN_TEST(TestRoundTrip);
+    RUN_TEST(TestCorruptImageThrows);
+}
@@ -0,0 +1,117 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using TransportCatalog::Transport::CatalogueSnapshot;
+using TransportCatalog::Transport::SnapshotPublisher;
+using TransportCatalog::Transport::TransportCatalogue;
+
+namespace {
+
+// Снимок совпадает со справочником в момент Freeze
+void AssertSnapshotMatches(const CatalogueSnapshot& snapshot, const TransportCatalogue& db) {
+    ASSERT_EQUAL(snapshot.GetAllStops().size(), db.GetAllStops().size());
+    ASSERT_EQUAL(snapshot.GetAllBuses().size(), db.GetAllBuses().size());
+    for (const auto& stop : db.GetAllStops()) {
+        ASSERT_EQUAL(snapshot.FindStop(stop.name)->id, stop.id);
+        std::vector<std::string_view> bus_names(snapshot.GetBusNamesByStop(stop.id).begin(),
+                                                snapshot.GetBusNamesByStop(stop.id).end());
+        const auto expected = db.GetBusesByStop(stop.name);
+        ASSERT(std::equal(bus_names.begin(), bus_names.end(), expected.begin(), expected.end()));
+        const auto bus_ids = snapshot.GetBusIdsByStop(stop.id);
+        const auto& expected_ids = db.GetBusIdsByStop(stop.id);
+        ASSERT(std::equal(bus_ids.begin(), bus_ids.end(), expected_ids.begin(), expected_ids.end()));
+        for (const auto& other : db.GetAllStops()) {
+            ASSERT_EQUAL(snapshot.GetDistance(stop.id, other.id), db.GetDistance(stop.id, other.id));
+        }
+    }
+    for (const auto& bus : db.GetAllBuses()) {
+        ASSERT_EQUAL(snapshot.FindBus(bus.name)->id, bus.id);
+        const auto& info = snapshot.GetBusInfo(bus.id);
+        const auto expected = db.GetBusInfo(bus.name);
+        ASSERT_EQUAL(info.stops_on_route, expected.stops_on_route);
+        ASSERT_EQUAL(info.unique_stops, expected.unique_stops);
+        ASSERT_EQUAL(info.route_length, expected.route_length);
+        ASSERT_EQUAL(info.curvature, expected.curvature);
+    }
+}
+
+// Изменения справочника после Freeze не видны в снимке
+void TestSnapshotIsIsolated() {
+    const auto network = tests::GenerateNetwork(9, 20, 8);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network, 5);
+    const auto snapshot = db.Freeze();
+    AssertSnapshotMatches(*snapshot, db);
+
+    TransportCatalogue before;
+    tests::LoadNetwork(before, network, 5);
+    db.AddStop("Extra", {55.6, 37.6});
+    const auto s0 = db.FindStop("S0")->id;
+    const auto s1 = db.FindStop("S1")->id;
+    db.SetDistance(s0, s1, 123456);
+    for (size_t k = 5; k < network.buses.size(); ++k) {
+        db.AddBus(network.buses[k].name, network.buses[k].stops, network.buses[k].is_roundtrip);
+    }
+
+    ASSERT(!snapshot->FindStop("Extra"));
+    ASSERT(!snapshot->FindBus(network.buses.back().name));
+    AssertSnapshotMatches(*snapshot, before);
+    AssertSnapshotMatches(*db.Freeze(), db);
+}
+
+// Читатель, взявший снимок, дорабатывает с ним после публикации нового
+void TestPublisherKeepsAcquiredSnapshot() {
+    TransportCatalogue db;
+    SnapshotPublisher publisher;
+    ASSERT(!publisher.Acquire());
+
+    db.AddStop("A", {55.6, 37.6});
+    publisher.Publish(db.Freeze());
+    const auto old_snapshot = publisher.Acquire();
+    db.AddStop("B", {55.7, 37.6});
+    publisher.Publish(db.Freeze());
+
+    ASSERT(!old_snapshot->FindStop("B"));
+    ASSERT(publisher.Acquire()->FindStop("B"));
+
+    // Читатели из других потоков видят целые снимки, пока идут публикации
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    std::atomic<size_t> bad_reads{0};
+    for (int k = 0; k < 3; ++k) {
+        readers.emplace_back([&] {
+            while (!done) {
+                const auto snapshot = publisher.Acquire();
+                const size_t count = snapshot->GetAllStops().size();
+                if (!snapshot->FindStop("S" + std::to_string(count - 1)) && count > 2) {
+                    ++bad_reads;
+                }
+            }
+        });
+    }
+    for (int k = 2; k < 200; ++k) {
+        db.AddStop("S" + std::to_string(k), {55.6, 37.6});
+        publisher.Publish(db.Freeze());
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    ASSERT_EQUAL(bad_reads.load(), 0u);
+}
+
+} // namespace
+
+void TestCatalogueSnapshot() {
+    RUN_TEST(TestSnapshotIsIsolated);
+    RUN_TEST(TestPublisherKeepsAcquiredSnapshot);
+}
@@ -0,0 +1,104 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "contraction_hierarchy.h"
+#include "graph.h"
+#include "router.h"
+
+#include <stdexcept>
+#include <string>
+
+using graph::ContractionHierarchy;
+using graph::DirectedWeightedGraph;
+using graph::Router;
+using graph::VertexId;
+
+namespace {
+
+// Иерархия находит пути того же веса, что и Router, для всех пар вершин,
+// и поиском между парой вершин, и из одной вершины во все; раскрытые
+// сокращения складываются в путь по рёбрам исходного графа
+void AssertSameRoutes(const DirectedWeightedGraph<double>& graph, const ContractionHierarchy<double>& hierarchy) {
+    const Router<double> router(graph);
+    for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+            const auto expected = router.GetRouteWeight(from, to);
+            const auto weight = hierarchy.GetRouteWeight(from, to);
+            const auto route = hierarchy.BuildRoute(from, to);
+            ASSERT_EQUAL_HINT(weight.has_value(), expected.has_value(), pair);
+            ASSERT_EQUAL_HINT(route.has_value(), expected.has_value(), pair);
+            if (expected) {
+                ASSERT_EQUAL_HINT(*weight, *expected, pair);
+                ASSERT_EQUAL_HINT(route->weight, *expected, pair);
+                tests::AssertRouteEdges(graph, from, to, route->edges, route->weight);
+            }
+        }
+    }
+    for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        const auto weights = hierarchy.GetRouteWeightsFrom(from);
+        for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+            const auto expected = router.GetRouteWeight(from, to);
+            ASSERT_EQUAL_HINT(weights[to].has_value(), expected.has_value(), pair);
+            if (expected) {
+                ASSERT_EQUAL_HINT(*weights[to], *expected, pair);
+            }
+        }
+    }
+}
+
+void TestMatchesRouter() {
+    for (const uint32_t seed : {1u, 2u, 3u}) {
+        // Разреженный граф с недостижимыми вершинами и плотный
+        for (const size_t edge_count : {60u, 400u}) {
+            const auto graph = tests::GenerateGraph(seed, 50, edge_count);
+            const ContractionHierarchy<double> hierarchy(graph);
+            AssertSameRoutes(graph, hierarchy);
+        }
+    }
+}
+
+// Пересжатие с новыми весами даёт те же пути, что и новая иерархия
+void TestRecontract() {
+    auto graph = tests::GenerateGraph(4, 50, 300);
+    ContractionHierarchy<double> hierarchy(graph);
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); edge_id += 3) {
+        graph.SetEdgeWeight(edge_id, graph.GetEdge(edge_id).weight * 2 + 1);
+    }
+    for (graph::EdgeId edge_id = 1; edge_id < graph.GetEdgeCount(); edge_id += 5) {
+        graph.SetEdgeWeight(edge_id, 0);
+    }
+    hierarchy.Recontract(graph);
+    AssertSameRoutes(graph, hierarchy);
+
+    // Число вершин менять нельзя
+    bool thrown = false;
+    try {
+        hierarchy.Recontract(tests::GenerateGraph(4, 51, 300));
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void TestNegativeWeightThrows() {
+    DirectedWeightedGraph<double> graph(2);
+    graph.AddEdge({0, 1, -1.0});
+    bool thrown = false;
+    try {
+        ContractionHierarchy<double> hierarchy(graph);
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+} // namespace
+
+void TestContractionHierarchy() {
+    RUN_TEST(TestMatchesRouter);
+    RUN_TEST(TestRecontract);
+    RUN_TEST(TestNegativeWeightThrows);
+}
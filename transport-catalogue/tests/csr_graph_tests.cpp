@@ -0,0 +1,121 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "csr_graph.h"
+#include "graph.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using graph::CsrDirection;
+using graph::CsrGraph;
+using graph::DirectedWeightedGraph;
+using graph::EdgeId;
+using graph::VertexId;
+
+namespace {
+
+// Дуги вершины — её исходящие (для INCOMING — входящие) рёбра в порядке
+// списка инцидентности; цель дуги — другой конец ребра
+template <typename Weight, typename GraphWeight, typename Convert>
+void AssertSameArcs(const DirectedWeightedGraph<GraphWeight>& graph, const CsrGraph<Weight>& csr,
+                    CsrDirection direction, Convert convert) {
+    const bool outgoing = direction == CsrDirection::OUTGOING;
+    ASSERT_EQUAL(csr.GetVertexCount(), graph.GetVertexCount());
+    ASSERT_EQUAL(csr.GetEdgeCount(), graph.GetEdgeCount());
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        const auto edges = outgoing ? graph.GetIncidentEdges(vertex) : graph.GetIncomingEdges(vertex);
+        std::vector<EdgeId> expected(edges.begin(), edges.end());
+        ASSERT_EQUAL_HINT(csr.GetArcsEnd(vertex) - csr.GetArcsBegin(vertex), expected.size(), std::to_string(vertex));
+        for (size_t k = 0; k < expected.size(); ++k) {
+            const size_t arc = csr.GetArcsBegin(vertex) + k;
+            const auto& edge = graph.GetEdge(expected[k]);
+            ASSERT_EQUAL(csr.GetEdgeId(arc), expected[k]);
+            ASSERT_EQUAL(csr.GetTarget(arc), outgoing ? edge.to : edge.from);
+            ASSERT_EQUAL(csr.GetWeight(arc), convert(edge.weight));
+        }
+    }
+}
+
+void TestMatchesGraph() {
+    const auto identity = [](double weight) {
+        return weight;
+    };
+    const auto to_tenths = [](double weight) {
+        return static_cast<uint32_t>(weight * 10);
+    };
+    for (const size_t edge_count : {0u, 60u, 400u}) {
+        auto graph = tests::GenerateGraph(3, 50, edge_count);
+        for (const CsrDirection direction : {CsrDirection::OUTGOING, CsrDirection::INCOMING}) {
+            CsrGraph<double> csr(graph, direction);
+            CsrGraph<uint32_t> converted(graph, direction, to_tenths);
+            AssertSameArcs(graph, csr, direction, identity);
+            AssertSameArcs(graph, converted, direction, to_tenths);
+
+            for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); edge_id += 3) {
+                graph.SetEdgeWeight(edge_id, graph.GetEdge(edge_id).weight + 1.5);
+            }
+            csr.UpdateWeights(graph);
+            converted.UpdateWeights(graph, to_tenths);
+            AssertSameArcs(graph, csr, direction, identity);
+            AssertSameArcs(graph, converted, direction, to_tenths);
+        }
+    }
+
+    const CsrGraph<double> empty;
+    ASSERT_EQUAL(empty.GetVertexCount(), 0u);
+    ASSERT_EQUAL(empty.GetEdgeCount(), 0u);
+}
+
+// View над массивами владеющего графа даёт те же дуги, номер ребра дуги —
+// её номер, а владелец дуги — вершина, в чьём списке она лежит
+void TestView() {
+    const auto graph = tests::GenerateGraph(4, 40, 150);
+    for (const CsrDirection direction : {CsrDirection::OUTGOING, CsrDirection::INCOMING}) {
+        const CsrGraph<double> csr(graph, direction);
+        std::vector<size_t> offsets{0};
+        std::vector<VertexId> targets;
+        std::vector<double> weights;
+        for (VertexId vertex = 0; vertex < csr.GetVertexCount(); ++vertex) {
+            for (size_t arc = csr.GetArcsBegin(vertex); arc < csr.GetArcsEnd(vertex); ++arc) {
+                targets.push_back(csr.GetTarget(arc));
+                weights.push_back(csr.GetWeight(arc));
+            }
+            offsets.push_back(targets.size());
+        }
+
+        auto view = CsrGraph<double>::View(csr.GetVertexCount(), offsets.data(), targets.data(), weights.data());
+        ASSERT(view.IsView() && !csr.IsView());
+        ASSERT_EQUAL(view.GetVertexCount(), csr.GetVertexCount());
+        ASSERT_EQUAL(view.GetEdgeCount(), csr.GetEdgeCount());
+        for (VertexId vertex = 0; vertex < view.GetVertexCount(); ++vertex) {
+            ASSERT_EQUAL(view.GetArcsBegin(vertex), csr.GetArcsBegin(vertex));
+            ASSERT_EQUAL(view.GetArcsEnd(vertex), csr.GetArcsEnd(vertex));
+            for (size_t arc = view.GetArcsBegin(vertex); arc < view.GetArcsEnd(vertex); ++arc) {
+                ASSERT_EQUAL(view.GetTarget(arc), csr.GetTarget(arc));
+                ASSERT_EQUAL(view.GetWeight(arc), csr.GetWeight(arc));
+                ASSERT_EQUAL(view.GetEdgeId(arc), arc);
+                ASSERT_EQUAL(view.GetArcOwner(arc), vertex);
+                ASSERT_EQUAL(csr.GetArcOwner(arc), vertex);
+            }
+        }
+
+        bool thrown = false;
+        try {
+            view.UpdateWeights(graph);
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+}
+
+} // namespace
+
+void TestCsrGraph() {
+    RUN_TEST(TestMatchesGraph);
+    RUN_TEST(TestView);
+}
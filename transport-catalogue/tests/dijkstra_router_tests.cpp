@@ -0,0 +1,234 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "csr_graph.h"
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using graph::CsrDirection;
+using graph::DijkstraRouter;
+using graph::DirectedWeightedGraph;
+using graph::Router;
+using graph::VertexId;
+
+namespace {
+
+uint32_t ToTenths(double weight) {
+    return static_cast<uint32_t>(weight * 10);
+}
+
+DirectedWeightedGraph<uint32_t> ConvertGraph(const DirectedWeightedGraph<double>& graph) {
+    DirectedWeightedGraph<uint32_t> converted(graph.GetVertexCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph.GetEdge(edge_id);
+        converted.AddEdge({edge.from, edge.to, ToTenths(edge.weight)});
+    }
+    return converted;
+}
+
+void AssertSameTrees(const DijkstraRouter<uint32_t>& expected, const DijkstraRouter<uint32_t, double>& actual,
+                     size_t vertex_count) {
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        const auto expected_tree = expected.BuildShortestPathTree(root);
+        const auto tree = actual.BuildShortestPathTree(root);
+        ASSERT_EQUAL_HINT(tree.prev_edges == expected_tree.prev_edges, true, std::to_string(root));
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            if (tree.IsReachable(vertex)) {
+                ASSERT_EQUAL(tree.weights[vertex], expected_tree.weights[vertex]);
+            }
+        }
+    }
+}
+
+// Поиск между парой вершин, дерево кратчайших путей в обе стороны и поиск
+// в пределах веса дают те же веса, что и Router, для всех пар вершин
+void TestMatchesRouter() {
+    const double max_weight = 15;
+    for (const uint32_t seed : {1u, 2u, 3u}) {
+        // Разреженный граф с недостижимыми вершинами и плотный
+        for (const size_t edge_count : {60u, 400u}) {
+            const auto graph = tests::GenerateGraph(seed, 50, edge_count);
+            const Router<double> router(graph);
+            const DijkstraRouter<double> forward(graph);
+            const DijkstraRouter<double> backward(graph, CsrDirection::INCOMING);
+            for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+                const auto tree = forward.BuildShortestPathTree(from);
+                const auto reverse_tree = backward.BuildShortestPathTree(from);
+                std::vector<std::pair<VertexId, double>> expected_reachable;
+                for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                    const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+                    const auto expected = router.GetRouteWeight(from, to);
+                    const auto route = forward.BuildRoute(from, to);
+                    const auto tree_route = forward.BuildRoute(tree, to);
+                    ASSERT_EQUAL_HINT(route.has_value(), expected.has_value(), pair);
+                    ASSERT_EQUAL_HINT(tree_route.has_value(), expected.has_value(), pair);
+                    if (expected) {
+                        ASSERT_EQUAL_HINT(route->weight, *expected, pair);
+                        ASSERT_EQUAL_HINT(tree_route->weight, *expected, pair);
+                        tests::AssertRouteEdges(graph, from, to, route->edges, route->weight);
+                        tests::AssertRouteEdges(graph, from, to, tree_route->edges, tree_route->weight);
+                        if (*expected <= max_weight) {
+                            expected_reachable.emplace_back(to, *expected);
+                        }
+                    }
+
+                    // Обратное дерево с корнем from хранит пути to -> from
+                    const auto expected_reverse = router.GetRouteWeight(to, from);
+                    const auto reverse_route = backward.BuildRoute(reverse_tree, to);
+                    ASSERT_EQUAL_HINT(reverse_route.has_value(), expected_reverse.has_value(), pair);
+                    if (expected_reverse) {
+                        ASSERT_EQUAL_HINT(reverse_route->weight, *expected_reverse, pair);
+                        tests::AssertRouteEdges(graph, to, from, reverse_route->edges, reverse_route->weight);
+                    }
+                }
+
+                // Вершины с равным весом могут идти в любом порядке
+                auto reachable = forward.FindReachableVertices(from, max_weight);
+                for (size_t i = 1; i < reachable.size(); ++i) {
+                    ASSERT(reachable[i - 1].second <= reachable[i].second);
+                }
+                const auto by_vertex = [](const auto& lhs, const auto& rhs) {
+                    return lhs.first < rhs.first;
+                };
+                std::sort(reachable.begin(), reachable.end(), by_vertex);
+                ASSERT_EQUAL_HINT(reachable == expected_reachable, true, std::to_string(from));
+            }
+        }
+    }
+}
+
+// Поиск с целыми весами, переведёнными из весов исходного графа при
+// построении CSR, совпадает с поиском по отдельной копии графа с целыми
+// весами, в том числе после изменения весов
+void TestConvertedWeights() {
+    auto graph = tests::GenerateGraph(5, 40, 200);
+    auto converted = ConvertGraph(graph);
+    for (const CsrDirection direction : {CsrDirection::OUTGOING, CsrDirection::INCOMING}) {
+        const DijkstraRouter<uint32_t> expected(converted, direction);
+        DijkstraRouter<uint32_t, double> actual(graph, direction, ToTenths);
+        AssertSameTrees(expected, actual, graph.GetVertexCount());
+    }
+
+    DijkstraRouter<uint32_t, double> router(graph, CsrDirection::OUTGOING, ToTenths);
+    for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); edge_id += 4) {
+        graph.SetEdgeWeight(edge_id, graph.GetEdge(edge_id).weight + 2.5);
+    }
+    router.UpdateWeights(ToTenths);
+    converted = ConvertGraph(graph);
+    AssertSameTrees(DijkstraRouter<uint32_t>(converted), router, graph.GetVertexCount());
+}
+
+// Дерево поиска из нескольких вершин с начальными весами хранит для каждой
+// вершины минимум по источникам из начального веса и расстояния от него,
+// а путь в дереве начинается в источнике, на котором минимум достигается
+void TestMultipleSources() {
+    const auto graph = ConvertGraph(tests::GenerateGraph(7, 50, 120));
+    const DijkstraRouter<uint32_t> router(graph);
+    const std::vector<DijkstraRouter<uint32_t>::Source> sources = {{3, 40}, {17, 0}, {29, 15}, {3, 25}};
+    const auto tree = router.BuildShortestPathTree(sources);
+    ASSERT_EQUAL(tree.root, 3u);
+    ASSERT(tree.IsRoot(17) && tree.IsRoot(29) && !tree.IsRoot(0));
+
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        std::optional<uint32_t> expected;
+        for (const auto& [source, initial_weight] : sources) {
+            const auto source_tree = router.BuildShortestPathTree(source);
+            if (source_tree.IsReachable(vertex) && (!expected || initial_weight + source_tree.weights[vertex] < *expected)) {
+                expected = initial_weight + source_tree.weights[vertex];
+            }
+        }
+        ASSERT_EQUAL_HINT(tree.IsReachable(vertex), expected.has_value(), std::to_string(vertex));
+        if (!expected) {
+            continue;
+        }
+        ASSERT_EQUAL_HINT(tree.weights[vertex], *expected, std::to_string(vertex));
+        const auto route = router.BuildRoute(tree, vertex);
+        ASSERT(route);
+        const VertexId start = route->edges.empty() ? vertex : graph.GetEdge(route->edges.front()).from;
+        ASSERT(tree.IsRoot(start));
+        uint32_t weight = start == 3 ? 25 : start == 17 ? 0 : 15;
+        VertexId current = start;
+        for (const graph::EdgeId edge_id : route->edges) {
+            const auto& edge = graph.GetEdge(edge_id);
+            ASSERT_EQUAL(edge.from, current);
+            current = edge.to;
+            weight += edge.weight;
+        }
+        ASSERT_EQUAL(current, vertex);
+        ASSERT_EQUAL(weight, route->weight);
+    }
+
+    bool thrown = false;
+    try {
+        router.BuildShortestPathTree(std::vector<DijkstraRouter<uint32_t>::Source>{});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+// Поиск по CsrGraph::View без исходного графа находит те же веса, а рёбра
+// его маршрутов — дуги, которые в CSR исходного графа соответствуют рёбрам
+// маршрутов обычного поиска
+void TestCsrView() {
+    const auto graph = tests::GenerateGraph(6, 50, 200);
+    const DijkstraRouter<double> expected(graph);
+    const graph::CsrGraph<double> csr(graph);
+    std::vector<size_t> offsets{0};
+    std::vector<VertexId> targets;
+    std::vector<double> weights;
+    for (VertexId vertex = 0; vertex < csr.GetVertexCount(); ++vertex) {
+        for (size_t arc = csr.GetArcsBegin(vertex); arc < csr.GetArcsEnd(vertex); ++arc) {
+            targets.push_back(csr.GetTarget(arc));
+            weights.push_back(csr.GetWeight(arc));
+        }
+        offsets.push_back(targets.size());
+    }
+    const DijkstraRouter<double> router(
+        graph::CsrGraph<double>::View(graph.GetVertexCount(), offsets.data(), targets.data(), weights.data()),
+        CsrDirection::OUTGOING);
+
+    const auto to_edges = [&csr](std::vector<graph::EdgeId> arcs) {
+        for (auto& arc : arcs) {
+            arc = csr.GetEdgeId(arc);
+        }
+        return arcs;
+    };
+    for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+        const auto expected_tree = expected.BuildShortestPathTree(from);
+        const auto tree = router.BuildShortestPathTree(from);
+        for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+            const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+            const auto expected_route = expected.BuildRoute(expected_tree, to);
+            const auto tree_route = router.BuildRoute(tree, to);
+            const auto route = router.BuildRoute(from, to);
+            ASSERT_EQUAL_HINT(tree_route.has_value(), expected_route.has_value(), pair);
+            ASSERT_EQUAL_HINT(route.has_value(), expected_route.has_value(), pair);
+            if (expected_route) {
+                ASSERT_EQUAL_HINT(tree_route->weight, expected_route->weight, pair);
+                ASSERT_EQUAL_HINT(route->weight, expected_route->weight, pair);
+                ASSERT_EQUAL_HINT(to_edges(tree_route->edges) == expected_route->edges, true, pair);
+                tests::AssertRouteEdges(graph, from, to, to_edges(route->edges), route->weight);
+            }
+        }
+    }
+}
+
+} // namespace
+
+void TestDijkstraRouter() {
+    RUN_TEST(TestMatchesRouter);
+    RUN_TEST(TestConvertedWeights);
+    RUN_TEST(TestMultipleSources);
+    RUN_TEST(TestCsrView);
+}
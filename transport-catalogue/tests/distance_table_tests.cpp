@@ -0,0 +1,103 @@
+#include "tests.h"
+#include "test_framework.h"
+
+#include "distance_table.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+
+using TransportCatalog::Transport::DistanceTable;
+
+namespace {
+
+using Key = std::pair<Domain::StopId, Domain::StopId>;
+
+// Обратное расстояние берётся, пока прямое не задано явно
+int GetExpected(const std::map<Key, int>& explicit_distances, Domain::StopId from, Domain::StopId to) {
+    if (const auto it = explicit_distances.find({from, to}); it != explicit_distances.end()) {
+        return it->second;
+    }
+    if (const auto it = explicit_distances.find({to, from}); it != explicit_distances.end()) {
+        return it->second;
+    }
+    return 0;
+}
+
+// Таблица ведёт себя как словарь явно заданных расстояний, в том числе
+// при перезаписи и после многократного роста; большие номера остановок
+// не мешают поиску
+void TestMatchesMap() {
+    std::mt19937 generator(23);
+    for (const Domain::StopId stop_count : {5u, 60u, 2000u}) {
+        DistanceTable table;
+        std::map<Key, int> explicit_distances;
+        std::uniform_int_distribution<Domain::StopId> stop(0, stop_count - 1);
+        const Domain::StopId offset = stop_count == 2000u ? 4'000'000'000u : 0u;
+        for (int step = 0; step < 5000; ++step) {
+            const Domain::StopId from = offset + stop(generator);
+            const Domain::StopId to = offset + stop(generator);
+            const int distance = std::uniform_int_distribution<int>(1, 100000)(generator);
+            table.Set(from, to, distance);
+            explicit_distances[{from, to}] = distance;
+
+            const Domain::StopId probe_from = offset + stop(generator);
+            const Domain::StopId probe_to = offset + stop(generator);
+            ASSERT_EQUAL(table.Get(probe_from, probe_to), GetExpected(explicit_distances, probe_from, probe_to));
+        }
+        for (Domain::StopId from = 0; from < std::min<Domain::StopId>(stop_count, 100); ++from) {
+            for (Domain::StopId to = 0; to < std::min<Domain::StopId>(stop_count, 100); ++to) {
+                ASSERT_EQUAL(table.Get(offset + from, offset + to),
+                             GetExpected(explicit_distances, offset + from, offset + to));
+            }
+        }
+
+        std::map<Key, int> listed;
+        table.ForEachExplicit([&listed](Domain::StopId from, Domain::StopId to, int distance) {
+            ASSERT(listed.emplace(Key{from, to}, distance).second);
+        });
+        ASSERT(listed == explicit_distances);
+        ASSERT(table.GetSize() >= explicit_distances.size());
+    }
+}
+
+// Перезапись заданного расстояния не увеличивает таблицу, даже когда
+// она заполнена до предела
+void TestOverwriteDoesNotGrow() {
+    DistanceTable table;
+    table.Set(0, 1, 10);
+    table.Set(2, 3, 20);
+    table.Set(4, 5, 30);
+    table.Set(6, 7, 40);
+    ASSERT_EQUAL(table.GetSize(), 8u);
+    const size_t memory = table.GetMemoryUsage();
+    table.Set(0, 1, 11);
+    table.Set(1, 0, 12);
+    table.Set(7, 6, 41);
+    ASSERT_EQUAL(table.GetMemoryUsage(), memory);
+    ASSERT_EQUAL(table.GetSize(), 8u);
+    ASSERT_EQUAL(table.Get(0, 1), 11);
+    ASSERT_EQUAL(table.Get(1, 0), 12);
+    ASSERT_EQUAL(table.Get(6, 7), 40);
+
+    // Новый ключ сверх половины заполненности расширяет таблицу
+    table.Set(8, 9, 50);
+    ASSERT(table.GetMemoryUsage() > memory);
+    ASSERT_EQUAL(table.Get(9, 8), 50);
+    ASSERT_EQUAL(table.Get(7, 6), 41);
+}
+
+void TestEmptyTable() {
+    const DistanceTable table;
+    ASSERT_EQUAL(table.Get(0, 1), 0);
+    ASSERT_EQUAL(table.GetSize(), 0u);
+}
+
+} // namespace
+
+void TestDistanceTable() {
+    RUN_TEST(TestMatchesMap);
+    RUN_TEST(TestOverwriteDoesNotGrow);
+    RUN_TEST(TestEmptyTable);
+}
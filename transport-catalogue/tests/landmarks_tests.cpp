@@ -0,0 +1,82 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "dijkstra_router.h"
+#include "graph.h"
+#include "landmarks.h"
+#include "router.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using graph::DijkstraRouter;
+using graph::LandmarkBounds;
+using graph::Router;
+using graph::VertexId;
+
+namespace {
+
+// Оценка не больше веса кратчайшего пути до цели, так что A* находит
+// пути того же веса, что и Router
+void TestBoundsAreAdmissible() {
+    for (const uint32_t seed : {1u, 2u, 3u}) {
+        // Разреженный граф с недостижимыми вершинами и плотный
+        for (const size_t edge_count : {60u, 400u}) {
+            const auto graph = tests::GenerateGraph(seed, 50, edge_count);
+            const Router<double> router(graph);
+            const DijkstraRouter<double> dijkstra(graph);
+            std::vector<VertexId> candidates(graph.GetVertexCount());
+            std::iota(candidates.begin(), candidates.end(), 0);
+            const LandmarkBounds<double> bounds(graph, candidates, 4);
+
+            auto landmarks = bounds.GetLandmarks();
+            ASSERT_EQUAL(landmarks.size(), 4u);
+            std::sort(landmarks.begin(), landmarks.end());
+            ASSERT(std::adjacent_find(landmarks.begin(), landmarks.end()) == landmarks.end());
+
+            for (VertexId to = 0; to < graph.GetVertexCount(); ++to) {
+                const auto potential = bounds.MakePotential(to);
+                ASSERT_EQUAL(potential(to), 0.0);
+                for (VertexId from = 0; from < graph.GetVertexCount(); ++from) {
+                    const std::string pair = std::to_string(from) + " -> " + std::to_string(to);
+                    const auto expected = router.GetRouteWeight(from, to);
+                    const auto route = dijkstra.BuildRouteAStar(from, to, potential);
+                    ASSERT_EQUAL_HINT(route.has_value(), expected.has_value(), pair);
+                    if (expected) {
+                        ASSERT_HINT(potential(from) <= *expected, pair);
+                        ASSERT_EQUAL_HINT(route->weight, *expected, pair);
+                        tests::AssertRouteEdges(graph, from, to, route->edges, route->weight);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Опорных вершин не больше, чем кандидатов, и все они из кандидатов
+void TestLandmarksFromCandidates() {
+    const auto graph = tests::GenerateGraph(7, 50, 300);
+    const std::vector<VertexId> candidates{3, 10, 20};
+    const LandmarkBounds<double> bounds(graph, candidates, 8);
+    auto landmarks = bounds.GetLandmarks();
+    std::sort(landmarks.begin(), landmarks.end());
+    ASSERT(landmarks == candidates);
+
+    // Без опорных вершин оценка нулевая
+    const LandmarkBounds<double> empty(graph, candidates, 0);
+    ASSERT(empty.GetLandmarks().empty());
+    const auto potential = empty.MakePotential(5);
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        ASSERT_EQUAL(potential(vertex), 0.0);
+    }
+}
+
+} // namespace
+
+void TestLandmarks() {
+    RUN_TEST(TestBoundsAreAdmissible);
+    RUN_TEST(TestLandmarksFromCandidates);
+}
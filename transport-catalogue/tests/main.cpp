@@ -0,0 +1,21 @@
+// Тесты собираются из каталога transport-catalogue вместе со всеми исходниками,
+// кроме main.cpp программы:
+//   g++ -std=c++17 -O2 -pthread -I. tests/*.cpp $(ls *.cpp | grep -v '^main.cpp$') -o transport_catalogue_tests
+#include "tests.h"
+
+int main() {
+    TestAllPairsTable();
+    TestCatalogueImage();
+    TestCatalogueSnapshot();
+    TestContractionHierarchy();
+    TestCsrGraph();
+    TestDijkstraRouter();
+    TestDistanceTable();
+    TestLandmarks();
+    TestParallel();
+    TestRadixHeap();
+    TestShortestPathTreeCache();
+    TestTransportCatalogue();
+    TestTransportRouter();
+    return 0;
+}
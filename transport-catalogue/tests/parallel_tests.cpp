@@ -0,0 +1,87 @@
+#include "tests.h"
+#include "test_framework.h"
+
+#include "parallel.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Каждый индекс обрабатывается ровно один раз
+template <typename ForEach>
+void AssertEachIndexOnce(ForEach for_each, size_t count) {
+    std::vector<std::atomic<int>> visits(count);
+    for_each(count, [&visits](size_t index) {
+        ++visits[index];
+    });
+    for (size_t index = 0; index < count; ++index) {
+        ASSERT_EQUAL(visits[index].load(), 1);
+    }
+}
+
+void TestForEachIndex() {
+    for (const size_t count : {0u, 1u, 7u, 1000u}) {
+        AssertEachIndexOnce([](size_t n, auto func) {
+            parallel::ForEachIndex(n, func, 4);
+        }, count);
+    }
+}
+
+void TestThreadPool() {
+    parallel::ThreadPool pool(4);
+    ASSERT_EQUAL(pool.GetThreadCount(), 4u);
+    for (const size_t count : {0u, 1u, 7u, 1000u}) {
+        AssertEachIndexOnce([&pool](size_t n, auto func) {
+            pool.ForEachIndex(n, func);
+        }, count);
+    }
+
+    // Исключение доходит до вызывающего, и пул остаётся рабочим
+    bool thrown = false;
+    try {
+        pool.ForEachIndex(100, [](size_t index) {
+            if (index == 42) {
+                throw std::runtime_error("fail");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    AssertEachIndexOnce([&pool](size_t n, auto func) {
+        pool.ForEachIndex(n, func);
+    }, 100);
+}
+
+// Вложенные вызовы и вызовы из нескольких потоков сразу завершаются
+void TestThreadPoolNestedAndConcurrentCalls() {
+    parallel::ThreadPool pool(3);
+    std::atomic<size_t> total{0};
+    std::vector<std::thread> callers;
+    for (int k = 0; k < 4; ++k) {
+        callers.emplace_back([&pool, &total] {
+            for (int round = 0; round < 50; ++round) {
+                pool.ForEachIndex(5, [&pool, &total](size_t) {
+                    pool.ForEachIndex(4, [&total](size_t) {
+                        ++total;
+                    });
+                });
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    ASSERT_EQUAL(total.load(), 4u * 50u * 5u * 4u);
+}
+
+} // namespace
+
+void TestParallel() {
+    RUN_TEST(TestForEachIndex);
+    RUN_TEST(TestThreadPool);
+    RUN_TEST(TestThreadPoolNestedAndConcurrentCalls);
+}
@@ -0,0 +1,82 @@
+#include "tests.h"
+#include "test_framework.h"
+
+#include "radix_heap.h"
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using graph::RadixHeap;
+
+namespace {
+
+// Вставки вперемешку с извлечениями, как в поиске Дейкстры: новый ключ не
+// меньше последнего извлечённого. Ключи извлекаются в том же порядке, что
+// и из двоичной кучи.
+template <typename Key>
+void AssertSameOrderAsPriorityQueue(uint32_t seed, Key max_step) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<Key> step(0, max_step);
+    std::uniform_int_distribution<int> push_count(0, 3);
+
+    RadixHeap<Key, int> heap;
+    std::priority_queue<Key, std::vector<Key>, std::greater<Key>> expected;
+    Key last_key = 0;
+    for (int value = 0; value < 2000; ++value) {
+        for (int k = push_count(generator); k > 0; --k) {
+            const Key key = last_key + step(generator);
+            heap.Push(key, value);
+            expected.push(key);
+        }
+        if (!expected.empty()) {
+            ASSERT(!heap.IsEmpty());
+            last_key = heap.Pop().first;
+            ASSERT_EQUAL(last_key, expected.top());
+            expected.pop();
+        }
+    }
+    while (!expected.empty()) {
+        ASSERT_EQUAL(heap.Pop().first, expected.top());
+        expected.pop();
+    }
+    ASSERT(heap.IsEmpty());
+}
+
+void TestMatchesPriorityQueue() {
+    for (const uint32_t seed : {1u, 2u, 3u}) {
+        AssertSameOrderAsPriorityQueue<uint32_t>(seed, 1000);
+        // Много равных ключей и ключи у верхней границы типа
+        AssertSameOrderAsPriorityQueue<uint32_t>(seed, 1);
+        AssertSameOrderAsPriorityQueue<uint64_t>(seed, uint64_t{1} << 40);
+        AssertSameOrderAsPriorityQueue<uint16_t>(seed, 0);
+    }
+}
+
+void TestPushBelowLastPoppedThrows() {
+    RadixHeap<uint32_t, int> heap;
+    heap.Push(5, 0);
+    heap.Pop();
+    bool thrown = false;
+    try {
+        heap.Push(4, 1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    // После очистки можно начинать с нуля
+    heap.Clear();
+    heap.Push(0, 2);
+    ASSERT_EQUAL(heap.Pop().second, 2);
+}
+
+} // namespace
+
+void TestRadixHeap() {
+    RUN_TEST(TestMatchesPriorityQueue);
+    RUN_TEST(TestPushBelowLastPoppedThrows);
+}
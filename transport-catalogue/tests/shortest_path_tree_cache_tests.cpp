@@ -0,0 +1,106 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "shortest_path_tree_cache.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <memory>
+
+using graph::ShortestPathTree;
+using graph::ShortestPathTreeCache;
+using TransportCatalog::Transport::TransportCatalogue;
+
+namespace {
+
+std::shared_ptr<const ShortestPathTree<double>> MakeTree(graph::VertexId root, size_t vertex_count = 10) {
+    auto tree = std::make_shared<ShortestPathTree<double>>();
+    tree->root = root;
+    tree->weights.assign(vertex_count, 0.0);
+    tree->prev_edges.assign(vertex_count, ShortestPathTree<double>::NO_EDGE);
+    return tree;
+}
+
+// Вытесняется давно не использованное дерево; обращение через Find
+// продлевает жизнь дерева
+void TestEvictsLeastRecentlyUsed() {
+    const size_t tree_bytes = MakeTree(0)->GetMemoryUsage();
+    ShortestPathTreeCache<double> cache(tree_bytes * 2 + tree_bytes / 2);
+    cache.Insert(MakeTree(0));
+    cache.Insert(MakeTree(1));
+    ASSERT(cache.Find(0));
+    cache.Insert(MakeTree(2));
+
+    ASSERT(cache.Find(0));
+    ASSERT(!cache.Find(1));
+    ASSERT(cache.Find(2));
+
+    const auto stats = cache.GetStats();
+    ASSERT_EQUAL(stats.hits, 3u);
+    ASSERT_EQUAL(stats.misses, 1u);
+    ASSERT_EQUAL(stats.evictions, 1u);
+    ASSERT_EQUAL(stats.entries, 2u);
+    ASSERT_EQUAL(stats.bytes_used, tree_bytes * 2);
+}
+
+// Дерево больше лимита не сохраняется и не вытесняет другие
+void TestOversizedTreeIsNotStored() {
+    const size_t tree_bytes = MakeTree(0)->GetMemoryUsage();
+    ShortestPathTreeCache<double> cache(tree_bytes * 2);
+    cache.Insert(MakeTree(0));
+    cache.Insert(MakeTree(1, 1000));
+    ASSERT(cache.Find(0));
+    ASSERT(!cache.Find(1));
+    ASSERT_EQUAL(cache.GetStats().evictions, 0u);
+}
+
+void TestEraseIf() {
+    ShortestPathTreeCache<double> cache(1 << 20);
+    for (graph::VertexId root = 0; root < 6; ++root) {
+        cache.Insert(MakeTree(root));
+    }
+    ASSERT_EQUAL(cache.EraseIf([](const ShortestPathTree<double>& tree) {
+        return tree.root % 2 == 0;
+    }), 3u);
+    ASSERT(!cache.Find(2));
+    ASSERT(cache.Find(3));
+    ASSERT_EQUAL(cache.GetStats().entries, 3u);
+    ASSERT_EQUAL(cache.GetStats().bytes_used, MakeTree(0)->GetMemoryUsage() * 3);
+}
+
+// Повторный пакет запросов маршрутизатор берёт из кэша деревьев
+void TestRouterUsesCache() {
+    const auto network = tests::GenerateNetwork(8, 20, 8);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+
+    RoutingSettings settings;
+    settings.bus_wait_time = 6;
+    settings.bus_velocity = 40;
+    settings.strategy = RoutingSettings::Strategy::DIJKSTRA;
+    const TransportRouter uncached(db, settings);
+    settings.tree_cache_bytes = 1 << 20;
+    const TransportRouter cached(db, settings);
+
+    tests::AssertSameTravelTimes(uncached, cached, stops);
+    const auto first = cached.GetTreeCacheStats();
+    ASSERT_EQUAL(first.hits, 0u);
+    ASSERT_EQUAL(first.entries, stops.size());
+    tests::AssertSameTravelTimes(uncached, cached, stops);
+    const auto second = cached.GetTreeCacheStats();
+    ASSERT_EQUAL(second.hits, stops.size());
+    ASSERT_EQUAL(second.misses, first.misses);
+
+    ASSERT_EQUAL(uncached.GetTreeCacheStats().entries, 0u);
+}
+
+} // namespace
+
+void TestShortestPathTreeCache() {
+    RUN_TEST(TestEvictsLeastRecentlyUsed);
+    RUN_TEST(TestOversizedTreeIsNotStored);
+    RUN_TEST(TestEraseIf);
+    RUN_TEST(TestRouterUsesCache);
+}
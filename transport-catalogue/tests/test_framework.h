@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Проверки для тестов: при ошибке печатают место и выражение и завершают программу
+
+template <typename T, typename U>
+void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std::string& u_str,
+                     const std::string& file, const std::string& func, unsigned line, const std::string& hint) {
+    if (t != u) {
+        std::cerr << file << "(" << line << "): " << func << ": ASSERT_EQUAL(" << t_str << ", " << u_str
+                  << ") failed: " << t << " != " << u << ".";
+        if (!hint.empty()) {
+            std::cerr << " Hint: " << hint;
+        }
+        std::cerr << std::endl;
+        std::abort();
+    }
+}
+
+inline void AssertImpl(bool value, const std::string& expr_str, const std::string& file, const std::string& func,
+                       unsigned line, const std::string& hint) {
+    if (!value) {
+        std::cerr << file << "(" << line << "): " << func << ": ASSERT(" << expr_str << ") failed.";
+        if (!hint.empty()) {
+            std::cerr << " Hint: " << hint;
+        }
+        std::cerr << std::endl;
+        std::abort();
+    }
+}
+
+// Относительная погрешность для времени в пути: пути одного веса могут
+// складываться из рёбер в разном порядке
+inline bool IsNear(double lhs, double rhs, double tolerance = 1e-9) {
+    return std::abs(lhs - rhs) <= tolerance * std::max(1.0, std::abs(lhs));
+}
+
+#define ASSERT_EQUAL(a, b) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, std::string())
+#define ASSERT_EQUAL_HINT(a, b, hint) AssertEqualImpl((a), (b), #a, #b, __FILE__, __FUNCTION__, __LINE__, (hint))
+#define ASSERT(expr) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, std::string())
+#define ASSERT_HINT(expr, hint) AssertImpl(!!(expr), #expr, __FILE__, __FUNCTION__, __LINE__, (hint))
+
+template <typename TestFunc>
+void RunTestImpl(TestFunc func, const std::string& test_name) {
+    func();
+    std::cerr << test_name << " OK" << std::endl;
+}
+
+#define RUN_TEST(func) RunTestImpl((func), #func)
@@ -0,0 +1,199 @@
+#include "test_network.h"
+#include "test_framework.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace tests {
+
+Network GenerateNetwork(uint32_t seed, size_t stop_count, size_t bus_count) {
+    std::mt19937 generator(seed);
+    auto uniform = [&generator](double from, double to) {
+        return std::uniform_real_distribution<double>(from, to)(generator);
+    };
+    auto chance = [&generator](double probability) {
+        return std::bernoulli_distribution(probability)(generator);
+    };
+
+    Network network;
+    for (size_t k = 0; k < stop_count; ++k) {
+        network.stops.push_back({"S" + std::to_string(k), {55.6 + uniform(-0.05, 0.05), 37.6 + uniform(-0.05, 0.05)}});
+    }
+
+    std::vector<size_t> order(stop_count);
+    std::iota(order.begin(), order.end(), 0);
+    for (size_t k = 0; k < bus_count; ++k) {
+        std::shuffle(order.begin(), order.end(), generator);
+        const size_t length = std::min(stop_count, std::uniform_int_distribution<size_t>(3, 8)(generator));
+        Network::Bus bus{"B" + std::to_string(k), {}, chance(0.3)};
+        for (size_t index = 0; index < length; ++index) {
+            bus.stops.push_back(network.stops[order[index]].name);
+        }
+        if (bus.is_roundtrip) {
+            bus.stops.push_back(bus.stops.front());
+        }
+        network.buses.push_back(std::move(bus));
+    }
+
+    // Дорога не короче прямой; расстояния повторно встреченных перегонов перезаписываются
+    auto coordinates = [&network](const std::string& name) {
+        return network.stops[std::stoul(name.substr(1))].coordinates;
+    };
+    for (const Network::Bus& bus : network.buses) {
+        for (size_t k = 1; k < bus.stops.size(); ++k) {
+            const auto& from = bus.stops[k - 1];
+            const auto& to = bus.stops[k];
+            const double geo_distance = Geo::ComputeDistance(coordinates(from), coordinates(to));
+            network.distances.push_back({from, to, static_cast<int>(geo_distance * uniform(1.0, 1.6)) + 1});
+            if (chance(0.4)) {
+                network.distances.push_back({to, from, static_cast<int>(geo_distance * uniform(1.0, 1.6)) + 1});
+            }
+        }
+    }
+    return network;
+}
+
+void LoadNetwork(TransportCatalog::Transport::TransportCatalogue& db, const Network& network, size_t bus_count) {
+    for (const auto& [name, coordinates] : network.stops) {
+        db.AddStop(name, coordinates);
+    }
+    for (const auto& [from, to, meters] : network.distances) {
+        db.SetDistance(db.FindStop(from)->id, db.FindStop(to)->id, meters);
+    }
+    for (size_t k = 0; k < bus_count; ++k) {
+        const Network::Bus& bus = network.buses[k];
+        db.AddBus(bus.name, bus.stops, bus.is_roundtrip);
+    }
+}
+
+void LoadNetwork(TransportCatalog::Transport::TransportCatalogue& db, const Network& network) {
+    LoadNetwork(db, network, network.buses.size());
+}
+
+std::vector<std::string_view> GetStopNames(const TransportCatalog::Transport::TransportCatalogue& db) {
+    std::vector<std::string_view> names;
+    for (const Domain::Stop& stop : db.GetAllStops()) {
+        names.push_back(stop.name);
+    }
+    return names;
+}
+
+std::vector<std::optional<double>> BuildAllTravelTimes(const TransportRouter& router,
+                                                       const std::vector<std::string_view>& stops) {
+    std::vector<std::pair<std::string_view, std::string_view>> requests;
+    for (const auto from : stops) {
+        for (const auto to : stops) {
+            requests.emplace_back(from, to);
+        }
+    }
+    std::vector<std::optional<double>> times;
+    for (const auto& route : router.BuildRoutes(requests)) {
+        if (!route) {
+            times.emplace_back();
+            continue;
+        }
+        // Время маршрута складывается из времени его элементов
+        double items_time = 0.0;
+        for (const auto& item : route->items) {
+            items_time += item.time;
+        }
+        ASSERT(IsNear(items_time, route->total_time));
+        times.push_back(route->total_time);
+    }
+    return times;
+}
+
+void AssertSameTravelTimes(const TransportRouter& expected, const TransportRouter& actual,
+                           const std::vector<std::string_view>& stops, double tolerance) {
+    const auto expected_times = BuildAllTravelTimes(expected, stops);
+    const auto actual_times = BuildAllTravelTimes(actual, stops);
+    for (size_t index = 0; index < expected_times.size(); ++index) {
+        const std::string pair = std::string(stops[index / stops.size()]) + " -> "
+            + std::string(stops[index % stops.size()]);
+        ASSERT_EQUAL_HINT(expected_times[index].has_value(), actual_times[index].has_value(), pair);
+        if (expected_times[index]) {
+            ASSERT_HINT(IsNear(*expected_times[index], *actual_times[index], tolerance), pair);
+        }
+    }
+}
+
+void AssertValidRoute(const TransportCatalog::Transport::TransportCatalogue& db, const RoutingSettings& settings,
+                      std::string_view from, std::string_view to, const TransportRouter::RouteInfo& route,
+                      double tolerance) {
+    const std::string pair = std::string(from) + " -> " + std::string(to);
+    const double bus_velocity = settings.bus_velocity * 1000 / 60;
+    const auto& stops = db.GetAllStops();
+    std::string_view stop = from;
+    bool waited = false;
+    double total_time = 0.0;
+    for (const auto& item : route.items) {
+        total_time += item.time;
+        if (item.type == TransportRouter::RouteItem::Type::WAIT) {
+            ASSERT_HINT(!waited, pair);
+            ASSERT_EQUAL_HINT(item.name, stop, pair);
+            ASSERT_HINT(IsNear(item.time, settings.bus_wait_time, tolerance), pair);
+            waited = true;
+            continue;
+        }
+        ASSERT_HINT(waited, pair);
+        waited = false;
+        const Domain::Bus* bus = db.FindBus(item.name);
+        ASSERT_HINT(bus != nullptr, pair);
+        ASSERT_HINT(item.span_count > 0, pair);
+
+        // Некольцевой автобус едет до конечной и обратно
+        std::vector<Domain::StopId> route_stops = bus->stops;
+        if (!bus->is_circular) {
+            route_stops.insert(route_stops.end(), bus->stops.rbegin() + 1, bus->stops.rend());
+        }
+        const size_t span_count = item.span_count;
+        bool found = false;
+        for (size_t begin = 0; !found && begin + span_count < route_stops.size(); ++begin) {
+            if (stops[route_stops[begin]].name != stop) {
+                continue;
+            }
+            int meters = 0;
+            for (size_t k = begin; k < begin + span_count; ++k) {
+                meters += db.GetDistance(route_stops[k], route_stops[k + 1]);
+            }
+            if (IsNear(meters / bus_velocity, item.time, tolerance)) {
+                found = true;
+                stop = stops[route_stops[begin + span_count]].name;
+            }
+        }
+        ASSERT_HINT(found, pair + " by " + std::string(item.name));
+    }
+    ASSERT_HINT(!waited, pair);
+    ASSERT_EQUAL_HINT(stop, to, pair);
+    ASSERT_HINT(IsNear(total_time, route.total_time, tolerance), pair);
+}
+
+graph::DirectedWeightedGraph<double> GenerateGraph(uint32_t seed, size_t vertex_count, size_t edge_count,
+                                                   int max_weight) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<graph::VertexId> vertex(0, vertex_count - 1);
+    std::uniform_int_distribution<int> weight(0, max_weight);
+
+    graph::DirectedWeightedGraph<double> graph(vertex_count);
+    for (size_t k = 0; k < edge_count; ++k) {
+        graph.AddEdge({vertex(generator), vertex(generator), static_cast<double>(weight(generator))});
+    }
+    return graph;
+}
+
+void AssertRouteEdges(const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from, graph::VertexId to,
+                      const std::vector<graph::EdgeId>& edges, double weight) {
+    graph::VertexId vertex = from;
+    double total = 0.0;
+    for (const graph::EdgeId edge_id : edges) {
+        const auto& edge = graph.GetEdge(edge_id);
+        ASSERT_EQUAL(edge.from, vertex);
+        vertex = edge.to;
+        total += edge.weight;
+    }
+    ASSERT_EQUAL(vertex, to);
+    ASSERT_EQUAL(total, weight);
+}
+
+} // namespace tests
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "graph.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tests {
+
+// Случайная транспортная сеть для сравнения маршрутизаторов между собой
+struct Network {
+    struct Stop {
+        std::string name;
+        Geo::Coordinates coordinates;
+    };
+    struct Distance {
+        std::string from;
+        std::string to;
+        int meters;
+    };
+    struct Bus {
+        std::string name;
+        std::vector<std::string> stops;  // у кольцевого последняя совпадает с первой
+        bool is_roundtrip;
+    };
+
+    std::vector<Stop> stops;
+    std::vector<Distance> distances;
+    std::vector<Bus> buses;
+};
+
+// Остановки S0, S1, ... в окрестности одной точки и автобусы B0, B1, ...
+// по случайным остановкам; у каждого перегона задано расстояние, иногда
+// и обратное
+Network GenerateNetwork(uint32_t seed, size_t stop_count, size_t bus_count);
+
+// Загружает все остановки и расстояния сети и первые bus_count автобусов
+void LoadNetwork(TransportCatalog::Transport::TransportCatalogue& db, const Network& network, size_t bus_count);
+void LoadNetwork(TransportCatalog::Transport::TransportCatalogue& db, const Network& network);
+
+std::vector<std::string_view> GetStopNames(const TransportCatalog::Transport::TransportCatalogue& db);
+
+// Время в пути между всеми парами остановок построчно, через BuildRoutes
+std::vector<std::optional<double>> BuildAllTravelTimes(const TransportRouter& router,
+                                                       const std::vector<std::string_view>& stops);
+
+// Маршрутизаторы дают одинаковое время в пути между всеми парами остановок
+void AssertSameTravelTimes(const TransportRouter& expected, const TransportRouter& actual,
+                           const std::vector<std::string_view>& stops, double tolerance = 1e-9);
+
+// Элементы маршрута складываются в поездку из from в to: ожидание на
+// остановке, затем поездка на span_count пролётов по маршруту автобуса
+// за время, равное дорожному расстоянию, делённому на скорость
+void AssertValidRoute(const TransportCatalog::Transport::TransportCatalogue& db, const RoutingSettings& settings,
+                      std::string_view from, std::string_view to, const TransportRouter::RouteInfo& route,
+                      double tolerance = 1e-9);
+
+// Случайный граф с целыми весами от 0 до max_weight, так что суммы весов
+// точны; среди рёбер бывают петли и параллельные рёбра
+graph::DirectedWeightedGraph<double> GenerateGraph(uint32_t seed, size_t vertex_count, size_t edge_count,
+                                                   int max_weight = 20);
+
+// Рёбра ведут из from в to одно за другим, и их веса дают в сумме weight
+void AssertRouteEdges(const graph::DirectedWeightedGraph<double>& graph, graph::VertexId from, graph::VertexId to,
+                      const std::vector<graph::EdgeId>& edges, double weight);
+
+} // namespace tests
@@ -0,0 +1,16 @@
+#pragma once
+
+// Наборы тестов по модулям; каждый запускает свои тесты через RUN_TEST
+void TestAllPairsTable();
+void TestCatalogueImage();
+void TestCatalogueSnapshot();
+void TestContractionHierarchy();
+void TestCsrGraph();
+void TestDijkstraRouter();
+void TestDistanceTable();
+void TestLandmarks();
+void TestParallel();
+void TestRadixHeap();
+void TestShortestPathTreeCache();
+void TestTransportCatalogue();
+void TestTransportRouter();
@@ -0,0 +1,164 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "transport_catalogue.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using TransportCatalog::Transport::TransportCatalogue;
+
+namespace {
+
+void AssertSameBusInfo(const Domain::BusInfo& actual, const Domain::BusInfo& expected, const std::string& hint) {
+    ASSERT_EQUAL_HINT(actual.stops_on_route, expected.stops_on_route, hint);
+    ASSERT_EQUAL_HINT(actual.unique_stops, expected.unique_stops, hint);
+    ASSERT_EQUAL_HINT(actual.route_length, expected.route_length, hint);
+    ASSERT_EQUAL_HINT(actual.geo_length, expected.geo_length, hint);
+    ASSERT_EQUAL_HINT(actual.curvature, expected.curvature, hint);
+}
+
+// Сохранённая информация об автобусах после каждой смены расстояния та же,
+// что у справочника, куда все расстояния записаны до автобусов, — в том
+// числе когда меняется обратное расстояние, заданное неявно
+void TestBusInfoAfterSetDistance() {
+    const auto network = tests::GenerateNetwork(31, 20, 8);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    std::vector<std::tuple<std::string, std::string, int>> distances;
+    for (const auto& [from, to, meters] : network.distances) {
+        distances.emplace_back(from, to, meters);
+    }
+
+    std::mt19937 generator(31);
+    for (int step = 0; step < 40; ++step) {
+        for (const auto& bus : network.buses) {
+            db.GetBusInfo(bus.name);
+        }
+        const auto& segment = network.distances[generator() % network.distances.size()];
+        const bool reverse = generator() % 2;
+        const std::string& from = reverse ? segment.to : segment.from;
+        const std::string& to = reverse ? segment.from : segment.to;
+        const int meters = 1000 + static_cast<int>(generator() % 5000);
+        db.SetDistance(db.FindStop(from)->id, db.FindStop(to)->id, meters);
+        distances.emplace_back(from, to, meters);
+
+        TransportCatalogue expected;
+        for (const auto& stop : network.stops) {
+            expected.AddStop(stop.name, stop.coordinates);
+        }
+        for (const auto& [first, second, distance] : distances) {
+            expected.SetDistance(expected.FindStop(first)->id, expected.FindStop(second)->id, distance);
+        }
+        for (const auto& bus : network.buses) {
+            expected.AddBus(bus.name, bus.stops, bus.is_roundtrip);
+        }
+        for (const auto& bus : network.buses) {
+            AssertSameBusInfo(db.GetBusInfo(bus.name), expected.GetBusInfo(bus.name),
+                              bus.name + " at step " + std::to_string(step));
+        }
+    }
+
+    // Неизвестный автобус
+    ASSERT_EQUAL(db.GetBusInfo("Unknown").stops_on_route, 0);
+}
+
+// Одновременные запросы из нескольких потоков дают тот же результат
+void TestConcurrentBusInfo() {
+    const auto network = tests::GenerateNetwork(32, 40, 30);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    TransportCatalogue expected;
+    tests::LoadNetwork(expected, network);
+
+    std::vector<std::vector<Domain::BusInfo>> results(4);
+    std::vector<std::thread> threads;
+    for (auto& result : results) {
+        threads.emplace_back([&db, &network, &result] {
+            for (const auto& bus : network.buses) {
+                result.push_back(db.GetBusInfo(bus.name));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& result : results) {
+        for (size_t k = 0; k < network.buses.size(); ++k) {
+            AssertSameBusInfo(result[k], expected.GetBusInfo(network.buses[k].name), network.buses[k].name);
+        }
+    }
+}
+
+// Номера остановок и автобусов идут подряд с нуля в порядке добавления
+void TestDenseIds() {
+    const auto network = tests::GenerateNetwork(33, 20, 8);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    for (size_t k = 0; k < network.stops.size(); ++k) {
+        const Domain::Stop* stop = db.FindStop(network.stops[k].name);
+        ASSERT_EQUAL(stop->id, k);
+        ASSERT_EQUAL(&db.GetStop(stop->id), stop);
+        ASSERT_EQUAL(&db.GetAllStops()[k], stop);
+    }
+    for (size_t k = 0; k < network.buses.size(); ++k) {
+        const Domain::Bus* bus = db.FindBus(network.buses[k].name);
+        ASSERT_EQUAL(bus->id, k);
+        ASSERT_EQUAL(&db.GetBus(bus->id), bus);
+        ASSERT_EQUAL(bus->stops.size(), network.buses[k].stops.size());
+        for (size_t index = 0; index < bus->stops.size(); ++index) {
+            ASSERT_EQUAL(db.GetStop(bus->stops[index]).name, network.buses[k].stops[index]);
+        }
+    }
+
+    // Автобус, дважды проходящий остановку, записан у неё один раз
+    db.AddStop("Extra", {55.6, 37.6});
+    db.AddBus("Twice", {"Extra", "S0", "Extra", "S1", "Extra"}, true);
+    const auto& extra_buses = db.GetBusIdsByStop(db.FindStop("Extra")->id);
+    ASSERT_EQUAL(extra_buses.size(), 1u);
+    ASSERT_EQUAL(extra_buses.front(), db.FindBus("Twice")->id);
+    ASSERT_EQUAL(db.GetBusIdsByStop(db.FindStop("S0")->id).back(), db.FindBus("Twice")->id);
+}
+
+// Повторное имя отвергается, и справочник остаётся прежним
+void TestDuplicateNamesThrow() {
+    TransportCatalogue db;
+    db.AddStop("A", {55.6, 37.6});
+    db.AddStop("B", {55.7, 37.6});
+    db.AddBus("X", {"A", "B"}, false);
+
+    bool thrown = false;
+    try {
+        db.AddStop("A", {10.0, 10.0});
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    ASSERT_EQUAL(db.GetAllStops().size(), 2u);
+    ASSERT_EQUAL(db.FindStop("A")->coordinates.lat, 55.6);
+
+    thrown = false;
+    try {
+        db.AddBus("X", {"B", "A"}, true);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    ASSERT_EQUAL(db.GetAllBuses().size(), 1u);
+    ASSERT_EQUAL(db.FindBus("X")->stops.front(), db.FindStop("A")->id);
+    ASSERT_EQUAL(db.GetBusIdsByStop(db.FindStop("A")->id).size(), 1u);
+}
+
+} // namespace
+
+void TestTransportCatalogue() {
+    RUN_TEST(TestDenseIds);
+    RUN_TEST(TestDuplicateNamesThrow);
+    RUN_TEST(TestBusInfoAfterSetDistance);
+    RUN_TEST(TestConcurrentBusInfo);
+}
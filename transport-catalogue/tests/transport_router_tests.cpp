@@ -0,0 +1,664 @@
+#include "tests.h"
+#include "test_framework.h"
+#include "test_network.h"
+
+#include "json_reader.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using TransportCatalog::Transport::TransportCatalogue;
+
+namespace {
+
+RoutingSettings MakeSettings(RoutingSettings::Strategy strategy,
+                             RoutingSettings::GraphModel graph_model = RoutingSettings::GraphModel::PAIRWISE) {
+    RoutingSettings settings;
+    settings.bus_wait_time = 6;
+    settings.bus_velocity = 40;
+    settings.strategy = strategy;
+    settings.graph_model = graph_model;
+    return settings;
+}
+
+// Все стратегии в обеих моделях графа и варианты DIJKSTRA
+std::vector<RoutingSettings> MakeSettingsVariants() {
+    using Strategy = RoutingSettings::Strategy;
+    std::vector<RoutingSettings> variants;
+    for (const auto model : {RoutingSettings::GraphModel::PAIRWISE, RoutingSettings::GraphModel::COMPACT}) {
+        for (const auto strategy : {Strategy::ALL_PAIRS, Strategy::DIJKSTRA, Strategy::CONTRACTION_HIERARCHY,
+                                    Strategy::ALL_PAIRS_COMPACT}) {
+            variants.push_back(MakeSettings(strategy, model));
+        }
+        RoutingSettings pruned = MakeSettings(Strategy::DIJKSTRA, model);
+        pruned.prune_parallel_edges = true;
+        variants.push_back(pruned);
+        RoutingSettings compressed = MakeSettings(Strategy::DIJKSTRA, model);
+        compressed.compress_chains = true;
+        variants.push_back(compressed);
+    }
+    RoutingSettings cached = MakeSettings(Strategy::DIJKSTRA);
+    cached.tree_cache_bytes = 1 << 20;
+    variants.push_back(cached);
+    RoutingSettings landmarks = MakeSettings(Strategy::DIJKSTRA);
+    landmarks.heuristic = RoutingSettings::Heuristic::LANDMARKS;
+    landmarks.landmark_count = 4;
+    variants.push_back(landmarks);
+    return variants;
+}
+
+// Все стратегии и модели графа находят маршруты того же времени, что и
+// таблица всех пар, и маршруты состоят из настоящих поездок
+void TestStrategiesMatchAllPairs() {
+    const auto network = tests::GenerateNetwork(21, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+    const TransportRouter expected(db, MakeSettings(RoutingSettings::Strategy::ALL_PAIRS));
+    for (const RoutingSettings& settings : MakeSettingsVariants()) {
+        const TransportRouter router(db, settings);
+        const double tolerance = settings.strategy == RoutingSettings::Strategy::ALL_PAIRS_COMPACT ? 1e-6 : 1e-9;
+        tests::AssertSameTravelTimes(expected, router, stops, tolerance);
+        for (const auto from : stops) {
+            for (const auto to : stops) {
+                if (const auto route = router.BuildRoute(from, to)) {
+                    tests::AssertValidRoute(db, settings, from, to, *route);
+                }
+            }
+        }
+    }
+}
+
+// Автобус по новым остановкам prefix0, prefix1, ... с разными расстояниями
+// между соседними остановками; кольцевой возвращается к prefix0
+void LoadLine(TransportCatalogue& db, const std::string& bus_name, const std::string& prefix, size_t stop_count,
+              bool is_circular) {
+    std::vector<std::string> names;
+    for (size_t k = 0; k < stop_count; ++k) {
+        names.push_back(prefix + std::to_string(k));
+        db.AddStop(names.back(), {55.6 + 0.001 * k, 37.6});
+        if (k > 0) {
+            db.SetDistance(db.FindStop(names[k - 1])->id, db.FindStop(names[k])->id, 100 + static_cast<int>(k));
+        }
+    }
+    if (is_circular) {
+        db.SetDistance(db.FindStop(names.back())->id, db.FindStop(names.front())->id, 500);
+        names.push_back(names.front());
+    }
+    db.AddBus(bus_name, names, is_circular);
+}
+
+// Элементы маршрута называют автобус и число пролётов, взятые из ребра,
+// при любой модели графа и стратегии
+void TestRouteItems() {
+    TransportCatalogue db;
+    LoadLine(db, "L", "L", 8, false);
+    LoadLine(db, "C", "C", 6, true);
+    db.SetDistance(db.FindStop("L5")->id, db.FindStop("C0")->id, 50);
+    db.AddBus("X", {"L5", "C0"}, false);
+
+    using Type = TransportRouter::RouteItem::Type;
+    for (const RoutingSettings& settings : MakeSettingsVariants()) {
+        const TransportRouter router(db, settings);
+        // L1 -> L5: 102 + 103 + 104 + 105 м, пересадка на X до C0 (50 м),
+        // затем C0 -> C3 по кольцу: 101 + 102 + 103 м
+        const auto route = router.BuildRoute("L1", "C3");
+        ASSERT(route);
+        ASSERT_EQUAL(route->items.size(), 6u);
+        const std::vector<std::pair<std::string_view, int>> rides{{"L", 4}, {"X", 1}, {"C", 3}};
+        for (size_t k = 0; k < rides.size(); ++k) {
+            const auto& wait = route->items[2 * k];
+            const auto& ride = route->items[2 * k + 1];
+            ASSERT(wait.type == Type::WAIT);
+            ASSERT(ride.type == Type::BUS);
+            ASSERT_EQUAL(ride.name, rides[k].first);
+            ASSERT_EQUAL(ride.span_count, rides[k].second);
+        }
+        ASSERT_EQUAL(route->items[0].name, "L1");
+        ASSERT_EQUAL(route->items[2].name, "L5");
+        ASSERT_EQUAL(route->items[4].name, "C0");
+        ASSERT(IsNear(route->items[1].time, (102 + 103 + 104 + 105) / (40 * 1000 / 60.0), 1e-6));
+        ASSERT(IsNear(route->total_time, 3 * 6 + (414 + 50 + 306) / (40 * 1000 / 60.0), 1e-6));
+
+        // Путь в ту же остановку пустой
+        const auto empty = router.BuildRoute("C3", "C3");
+        ASSERT(empty && empty->items.empty() && empty->total_time == 0);
+    }
+}
+
+// Компактная модель обходится числом рёбер, линейным по числу остановок
+// автобуса, тогда как попарная соединяет каждую пару его остановок по ходу
+// движения
+void TestCompactModelEdgeCount() {
+    const size_t stop_count = 30;
+    for (const bool is_circular : {false, true}) {
+        TransportCatalogue db;
+        LoadLine(db, "L", "L", stop_count, is_circular);
+        const TransportRouter pairwise(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA));
+        const TransportRouter compact(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA,
+                                                       RoutingSettings::GraphModel::COMPACT));
+        ASSERT(pairwise.ExportGraph().edges.size() >= stop_count * (stop_count - 1) / 2);
+        ASSERT(compact.ExportGraph().edges.size() <= 6 * stop_count);
+        tests::AssertSameTravelTimes(pairwise, compact, tests::GetStopNames(db));
+    }
+}
+
+// Автобусы по общим остановкам дают параллельные рёбра; после отсечения
+// между парой вершин остаётся одно ребро, а маршруты не меняются
+void TestPruneParallelEdges() {
+    TransportCatalogue db;
+    LoadLine(db, "L", "L", 12, false);
+    const auto add_bus = [&db](const std::string& name, size_t first, size_t last, bool is_circular) {
+        std::vector<std::string> stops;
+        for (size_t k = first; k <= last; ++k) {
+            stops.push_back("L" + std::to_string(k));
+        }
+        if (is_circular) {
+            stops.push_back(stops.front());
+        }
+        db.AddBus(name, stops, is_circular);
+    };
+    add_bus("M", 2, 9, false);
+    add_bus("N", 0, 11, true);
+    add_bus("P", 4, 6, false);
+
+    for (const auto model : {RoutingSettings::GraphModel::PAIRWISE, RoutingSettings::GraphModel::COMPACT}) {
+        RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA, model);
+        const TransportRouter full(db, settings);
+        settings.prune_parallel_edges = true;
+        const TransportRouter pruned(db, settings);
+
+        const auto full_edges = full.ExportGraph().edges;
+        const auto pruned_edges = pruned.ExportGraph().edges;
+        if (model == RoutingSettings::GraphModel::PAIRWISE) {
+            ASSERT(pruned_edges.size() < full_edges.size());
+            std::vector<std::pair<graph::VertexId, graph::VertexId>> pairs;
+            for (const auto& edge : pruned_edges) {
+                pairs.emplace_back(edge.from, edge.to);
+            }
+            std::sort(pairs.begin(), pairs.end());
+            ASSERT(std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end());
+        } else {
+            // У компактной модели свои вершины на каждый автобус, параллельных рёбер нет
+            ASSERT_EQUAL(pruned_edges.size(), full_edges.size());
+        }
+
+        const auto stops = tests::GetStopNames(db);
+        tests::AssertSameTravelTimes(full, pruned, stops);
+        for (const auto from : stops) {
+            for (const auto to : stops) {
+                if (const auto route = pruned.BuildRoute(from, to)) {
+                    tests::AssertValidRoute(db, settings, from, to, *route);
+                }
+            }
+        }
+    }
+}
+
+// Маршруты из проходных остановок, в них и между двумя проходными
+// остановками одного автобуса, в том числе против хода кольцевого, те же,
+// что и в полном графе, и после правок справочника
+void TestCompressChains() {
+    for (const auto model : {RoutingSettings::GraphModel::PAIRWISE, RoutingSettings::GraphModel::COMPACT}) {
+        RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA, model);
+        RoutingSettings compressed_settings = settings;
+        compressed_settings.compress_chains = true;
+
+        // Линия и кольцо, связанные одним автобусом: проходные почти все остановки
+        TransportCatalogue edited;
+        LoadLine(edited, "L", "L", 12, false);
+        LoadLine(edited, "C", "C", 10, true);
+        edited.SetDistance(edited.FindStop("L3")->id, edited.FindStop("C5")->id, 700);
+        edited.AddBus("X", {"L3", "C5"}, false);
+        TransportRouter router(edited, compressed_settings);
+
+        // Граф со сжатыми цепочками не выгружается, так что цепочки нашлись
+        bool thrown = false;
+        try {
+            router.ExportGraph();
+        } catch (const std::logic_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+
+        const auto assert_same = [&settings, &compressed_settings](const TransportCatalogue& db,
+                                                                  const TransportRouter& router) {
+            const auto stops = tests::GetStopNames(db);
+            tests::AssertSameTravelTimes(TransportRouter(db, settings), router, stops);
+            for (const auto from : stops) {
+                for (const auto to : stops) {
+                    if (const auto route = router.BuildRoute(from, to)) {
+                        tests::AssertValidRoute(db, compressed_settings, from, to, *route);
+                    }
+                }
+            }
+        };
+        assert_same(edited, router);
+
+        // Перегон внутри цепочки стал длиннее
+        edited.SetDistance(edited.FindStop("L6")->id, edited.FindStop("L7")->id, 900);
+        router.UpdateCatalogue(edited.Freeze());
+        router.UpdateDistance("L6", "L7");
+        assert_same(edited, router);
+
+        // Новый автобус делает проходные остановки пересадочными
+        edited.SetDistance(edited.FindStop("L8")->id, edited.FindStop("C2")->id, 300);
+        edited.AddBus("Y", {"L8", "C2"}, false);
+        router.UpdateCatalogue(edited.Freeze());
+        router.AddBus("Y");
+        assert_same(edited, router);
+    }
+}
+
+// Расстояния, автобусы, остановка и время ожидания, добавленные после
+// построения, дают те же маршруты, что и построение по готовому справочнику
+void TestIncrementalUpdateMatchesRebuild() {
+    const auto network = tests::GenerateNetwork(14, 30, 10);
+    const size_t initial_bus_count = 7;
+    for (const RoutingSettings& settings : MakeSettingsVariants()) {
+        TransportCatalogue full;
+        tests::LoadNetwork(full, network);
+        full.AddStop("Extra", {55.6, 37.6});
+        const TransportRouter rebuilt(full, settings);
+
+        TransportCatalogue db;
+        tests::LoadNetwork(db, network, initial_bus_count);
+        for (size_t k = 0; k < network.distances.size(); k += 3) {
+            const auto& [from, to, meters] = network.distances[k];
+            db.SetDistance(db.FindStop(from)->id, db.FindStop(to)->id, meters * 2);
+        }
+        RoutingSettings initial_settings = settings;
+        initial_settings.bus_wait_time += 2;
+        TransportRouter router(db, initial_settings);
+
+        for (const auto& [from, to, meters] : network.distances) {
+            db.SetDistance(db.FindStop(from)->id, db.FindStop(to)->id, meters);
+        }
+        for (size_t k = initial_bus_count; k < network.buses.size(); ++k) {
+            const auto& bus = network.buses[k];
+            db.AddBus(bus.name, bus.stops, bus.is_roundtrip);
+        }
+        db.AddStop("Extra", {55.6, 37.6});
+
+        router.UpdateCatalogue(db.Freeze());
+        for (const auto& [from, to, meters] : network.distances) {
+            router.UpdateDistance(from, to);
+        }
+        for (size_t k = initial_bus_count; k < network.buses.size(); ++k) {
+            router.AddBus(network.buses[k].name);
+        }
+        router.AddStop("Extra");
+        router.UpdateSettings(settings);
+
+        tests::AssertSameTravelTimes(rebuilt, router, tests::GetStopNames(full));
+    }
+}
+
+// Правки справочника не видны маршрутизатору, пока он не получил новый снимок
+void TestRouterReadsOwnSnapshot() {
+    TransportCatalogue db;
+    LoadLine(db, "L", "L", 5, false);
+    TransportRouter router(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA));
+    const auto before = router.BuildRoute("L0", "L4");
+    ASSERT(before);
+
+    db.SetDistance(db.FindStop("L1")->id, db.FindStop("L2")->id, 5000);
+    db.AddStop("M", {55.7, 37.7});
+    db.SetDistance(db.FindStop("L4")->id, db.FindStop("M")->id, 300);
+    db.AddBus("N", {"L4", "M"}, false);
+    const auto unchanged = router.BuildRoute("L0", "L4");
+    ASSERT(unchanged);
+    ASSERT_EQUAL(unchanged->total_time, before->total_time);
+    ASSERT(!router.GetCatalogue()->FindStop("M"));
+
+    // До перехода на новый снимок остановки и автобуса для маршрутизатора нет
+    bool thrown = false;
+    try {
+        router.BuildRoute("L0", "M");
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+    thrown = false;
+    try {
+        router.AddBus("N");
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    const auto snapshot = db.Freeze();
+    router.UpdateCatalogue(snapshot);
+    router.UpdateDistance("L1", "L2");
+    router.AddBus("N");
+    ASSERT_EQUAL(router.GetCatalogue(), snapshot);
+    const auto changed = router.BuildRoute("L0", "L4");
+    ASSERT(changed);
+    ASSERT(changed->total_time > before->total_time);
+    tests::AssertSameTravelTimes(TransportRouter(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA)), router,
+                                 tests::GetStopNames(db));
+
+    // Снимок с меньшим числом остановок не подходит
+    TransportCatalogue other;
+    LoadLine(other, "L", "L", 3, false);
+    thrown = false;
+    try {
+        router.UpdateCatalogue(other.Freeze());
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+void TestAddBusTwiceThrows() {
+    const auto network = tests::GenerateNetwork(3, 10, 3);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    TransportRouter router(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA));
+    try {
+        router.AddBus("B0");
+        ASSERT_HINT(false, "bus B0 is already routed");
+    } catch (const std::invalid_argument&) {
+    }
+}
+
+// Пакет "updates" из входного JSON проходит через те же методы
+void TestApplyUpdates() {
+    using namespace std::literals;
+    const json::Array base_requests{
+        json::Dict{{"type"s, "Stop"s}, {"name"s, "A"s}, {"latitude"s, 55.60}, {"longitude"s, 37.60},
+                   {"road_distances"s, json::Dict{{"B"s, 1000}}}},
+        json::Dict{{"type"s, "Stop"s}, {"name"s, "B"s}, {"latitude"s, 55.61}, {"longitude"s, 37.60},
+                   {"road_distances"s, json::Dict{}}},
+        json::Dict{{"type"s, "Bus"s}, {"name"s, "1"s}, {"stops"s, json::Array{"A"s, "B"s}}, {"is_roundtrip"s, false}},
+    };
+    TransportCatalogue db;
+    json_reader::FillTransportCatalogue(db, base_requests);
+    TransportRouter router(db, json_reader::ParseRoutingSettings(json::Dict{{"bus_wait_time"s, 5}, {"bus_velocity"s, 60}}));
+
+    // 60 км/ч — 1000 м в минуту
+    const json::Dict updates{
+        {"base_requests"s, json::Array{
+            json::Dict{{"type"s, "Stop"s}, {"name"s, "C"s}, {"latitude"s, 55.62}, {"longitude"s, 37.60},
+                       {"road_distances"s, json::Dict{}}},
+            json::Dict{{"type"s, "Stop"s}, {"name"s, "B"s}, {"road_distances"s, json::Dict{{"A"s, 2000}, {"C"s, 3000}}}},
+            json::Dict{{"type"s, "Bus"s}, {"name"s, "2"s}, {"stops"s, json::Array{"B"s, "C"s}}, {"is_roundtrip"s, false}},
+        }},
+        {"routing_settings"s, json::Dict{{"bus_wait_time"s, 2}, {"bus_velocity"s, 60}}},
+    };
+    json_reader::ApplyUpdates(db, router, updates);
+
+    ASSERT(db.FindBus("2"));
+    const auto to_c = router.BuildRoute("A", "C");
+    ASSERT(to_c);
+    ASSERT(IsNear(to_c->total_time, 2 + 1 + 2 + 3));
+    const auto back = router.BuildRoute("B", "A");
+    ASSERT(back);
+    ASSERT(IsNear(back->total_time, 2 + 2));
+}
+
+// Веса в миллисекундах округляются вверх по рёбрам, поэтому время в пути
+// отличается от точного не больше чем на миллисекунды, в том числе после
+// пересчёта весов без перестроения графа
+void TestFixedPointWeights() {
+    const auto network = tests::GenerateNetwork(21, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+    for (const auto model : {RoutingSettings::GraphModel::PAIRWISE, RoutingSettings::GraphModel::COMPACT}) {
+        RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA, model);
+        TransportRouter exact(db, settings);
+        settings.fixed_point_weights = true;
+        TransportRouter fixed_point(db, settings);
+        tests::AssertSameTravelTimes(exact, fixed_point, stops, 1e-4);
+
+        settings.bus_wait_time = 2;
+        settings.bus_velocity = 25;
+        fixed_point.UpdateSettings(settings);
+        settings.fixed_point_weights = false;
+        exact.UpdateSettings(settings);
+        tests::AssertSameTravelTimes(exact, fixed_point, stops, 1e-4);
+    }
+}
+
+// Счётчики поисков растут с каждым запросом, а оценки ALT сокращают число
+// извлечённых из очереди вершин
+void TestSearchStats() {
+    const auto network = tests::GenerateNetwork(3, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+
+    const TransportRouter plain(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA));
+    ASSERT_EQUAL(plain.GetSearchStats().searches, 0u);
+    ASSERT(plain.BuildRoute(stops[0], stops[1]));
+    ASSERT_EQUAL(plain.GetSearchStats().searches, 1u);
+    ASSERT(plain.GetSearchStats().settled_vertices > 0);
+
+    RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA);
+    settings.heuristic = RoutingSettings::Heuristic::LANDMARKS;
+    settings.landmark_count = 4;
+    const TransportRouter landmarks(db, settings);
+    const auto before = plain.GetSearchStats();
+    for (const auto from : stops) {
+        for (const auto to : stops) {
+            ASSERT_EQUAL(plain.BuildRoute(from, to).has_value(), landmarks.BuildRoute(from, to).has_value());
+        }
+    }
+    const auto after = plain.GetSearchStats();
+    ASSERT_EQUAL(after.searches - before.searches, stops.size() * stops.size());
+    ASSERT_EQUAL(landmarks.GetSearchStats().searches, stops.size() * stops.size());
+    ASSERT(landmarks.GetSearchStats().settled_vertices < after.settled_vertices - before.settled_vertices);
+
+    // Из проходной остановки — один поиск сразу из всех вершин, куда она
+    // довозит, и для маршрута, и для строки матрицы
+    RoutingSettings compressed_settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA);
+    compressed_settings.compress_chains = true;
+    TransportCatalogue lines;
+    LoadLine(lines, "L", "L", 12, false);
+    LoadLine(lines, "C", "C", 10, true);
+    lines.SetDistance(lines.FindStop("L3")->id, lines.FindStop("C5")->id, 700);
+    lines.AddBus("X", {"L3", "C5"}, false);
+    const TransportRouter compressed(lines, compressed_settings);
+    ASSERT(compressed.BuildRoute("L6", "C2"));
+    ASSERT_EQUAL(compressed.GetSearchStats().searches, 1u);
+    const std::vector<std::string_view> destinations = {"L1", "L9", "C2", "C7"};
+    compressed.BuildTravelTimeMatrix({"L6"}, destinations);
+    ASSERT_EQUAL(compressed.GetSearchStats().searches, 2u);
+
+    // Таблица всех пар отвечает без поиска
+    const TransportRouter table(db, MakeSettings(RoutingSettings::Strategy::ALL_PAIRS));
+    ASSERT(table.BuildRoute(stops[0], stops[1]));
+    ASSERT_EQUAL(table.GetSearchStats().searches, 0u);
+}
+
+// Пакет маршрутов даёт то же время, что и маршруты по одному, и каждый
+// маршрут пакета состоит из настоящих поездок
+void AssertBatchMatchesSingleRoutes(const TransportCatalogue& db, const RoutingSettings& settings,
+                                    const TransportRouter& router,
+                                    const std::vector<std::pair<std::string_view, std::string_view>>& requests) {
+    // Целые веса допускают маршрут длиннее кратчайшего на миллисекунды
+    const double tolerance = settings.fixed_point_weights ? 1e-4
+        : settings.strategy == RoutingSettings::Strategy::ALL_PAIRS_COMPACT ? 1e-6 : 1e-9;
+    const auto routes = router.BuildRoutes(requests);
+    ASSERT_EQUAL(routes.size(), requests.size());
+    for (size_t index = 0; index < requests.size(); ++index) {
+        const auto& [from, to] = requests[index];
+        const std::string pair = std::string(from) + " -> " + std::string(to);
+        const auto expected = router.BuildRoute(from, to);
+        ASSERT_EQUAL_HINT(routes[index].has_value(), expected.has_value(), pair);
+        if (expected) {
+            ASSERT_HINT(IsNear(routes[index]->total_time, expected->total_time, tolerance), pair);
+            tests::AssertValidRoute(db, settings, from, to, *routes[index]);
+        }
+    }
+}
+
+// Пакет из повторяющихся остановок отправления в случайном порядке при
+// любой стратегии; на каждую остановку отправления — один поиск
+void TestBatchedRoutes() {
+    const auto network = tests::GenerateNetwork(18, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+
+    std::mt19937 generator(18);
+    std::vector<std::pair<std::string_view, std::string_view>> requests;
+    for (int k = 0; k < 300; ++k) {
+        requests.emplace_back(stops[generator() % 6], stops[generator() % stops.size()]);
+    }
+    auto variants = MakeSettingsVariants();
+    RoutingSettings fixed_point = MakeSettings(RoutingSettings::Strategy::DIJKSTRA);
+    fixed_point.fixed_point_weights = true;
+    variants.push_back(fixed_point);
+    for (const RoutingSettings& settings : variants) {
+        const TransportRouter router(db, settings);
+        AssertBatchMatchesSingleRoutes(db, settings, router, requests);
+    }
+
+    const TransportRouter router(db, MakeSettings(RoutingSettings::Strategy::DIJKSTRA));
+    std::vector<std::pair<std::string_view, std::string_view>> one_origin;
+    for (const auto to : stops) {
+        one_origin.emplace_back(stops[0], to);
+    }
+    router.BuildRoutes(one_origin);
+    ASSERT_EQUAL(router.GetSearchStats().searches, 1u);
+    ASSERT(router.BuildRoutes({}).empty());
+}
+
+// Запросы, сходящиеся к одной остановке, решаются одним обратным поиском
+// с теми же маршрутами, что и прямые поиски, в том числе с целыми весами
+// и вперемешку с запросами из общих остановок отправления
+void TestManyToOneRoutes() {
+    const auto network = tests::GenerateNetwork(20, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+
+    std::vector<std::pair<std::string_view, std::string_view>> to_one;
+    for (const auto from : stops) {
+        to_one.emplace_back(from, stops[4]);
+    }
+    std::vector<std::pair<std::string_view, std::string_view>> mixed = to_one;
+    for (const auto to : stops) {
+        mixed.emplace_back(stops[9], to);
+    }
+
+    for (const bool fixed_point_weights : {false, true}) {
+        RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::DIJKSTRA);
+        settings.fixed_point_weights = fixed_point_weights;
+        const TransportRouter router(db, settings);
+        AssertBatchMatchesSingleRoutes(db, settings, router, to_one);
+        AssertBatchMatchesSingleRoutes(db, settings, router, mixed);
+
+        const TransportRouter counted(db, settings);
+        counted.BuildRoutes(to_one);
+        ASSERT_EQUAL(counted.GetSearchStats().searches, 1u);
+        counted.BuildRoutes(mixed);
+        ASSERT_EQUAL(counted.GetSearchStats().searches, 3u);
+    }
+}
+
+// AUTO берёт таблицу всех пар для небольшого графа, а если в бюджет памяти
+// не помещается ничего — поиск Дейкстры без кэша; маршруты те же
+void TestAutoStrategy() {
+    const auto network = tests::GenerateNetwork(19, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+    const TransportRouter expected(db, MakeSettings(RoutingSettings::Strategy::ALL_PAIRS));
+
+    const TransportRouter table(db, MakeSettings(RoutingSettings::Strategy::AUTO));
+    tests::AssertSameTravelTimes(expected, table, stops, 1e-6);
+    ASSERT_EQUAL(table.GetSearchStats().searches, 0u);
+
+    RoutingSettings settings = MakeSettings(RoutingSettings::Strategy::AUTO);
+    settings.memory_budget_bytes = 1;
+    const TransportRouter search(db, settings);
+    tests::AssertSameTravelTimes(expected, search, stops);
+    ASSERT(search.GetSearchStats().searches > 0);
+    const auto cache_stats = search.GetTreeCacheStats();
+    ASSERT_EQUAL(cache_stats.hits + cache_stats.misses, 0u);
+}
+
+// Матрица времени и изохрона согласуются с маршрутами при любой стратегии,
+// в том числе когда иерархия сжатия проходит из остановки во все вершины
+void TestMatrixAndIsochroneMatchRoutes() {
+    const auto network = tests::GenerateNetwork(17, 30, 10);
+    TransportCatalogue db;
+    tests::LoadNetwork(db, network);
+    const auto stops = tests::GetStopNames(db);
+    for (const RoutingSettings& settings : MakeSettingsVariants()) {
+        const TransportRouter router(db, settings);
+        const auto times = tests::BuildAllTravelTimes(router, stops);
+        // Плоская таблица хранит веса во float, маршруты же складываются из рёбер
+        const double tolerance = settings.strategy == RoutingSettings::Strategy::ALL_PAIRS_COMPACT ? 1e-6 : 1e-9;
+
+        const auto matrix = router.BuildTravelTimeMatrix(stops, stops);
+        ASSERT_EQUAL(matrix.size(), times.size());
+        for (size_t index = 0; index < times.size(); ++index) {
+            ASSERT_EQUAL(matrix[index].has_value(), times[index].has_value());
+            if (times[index]) {
+                ASSERT(IsNear(*matrix[index], *times[index], tolerance));
+            }
+        }
+
+        // Двум целям хватает поиска между парами
+        const std::vector<std::string_view> few{stops[3], stops[7]};
+        const auto few_matrix = router.BuildTravelTimeMatrix(stops, few);
+        for (size_t row = 0; row < stops.size(); ++row) {
+            for (size_t column = 0; column < few.size(); ++column) {
+                const auto& expected = matrix[row * stops.size() + (column == 0 ? 3 : 7)];
+                const auto& actual = few_matrix[row * few.size() + column];
+                ASSERT_EQUAL(actual.has_value(), expected.has_value());
+                if (expected) {
+                    ASSERT(IsNear(*actual, *expected, tolerance));
+                }
+            }
+        }
+
+        for (const double max_time : {0.0, 10.0, 25.0, 1000.0}) {
+            for (size_t row = 0; row < stops.size(); row += 7) {
+                const auto reachable = router.FindReachableStops(stops[row], max_time);
+                size_t expected_count = 0;
+                for (size_t column = 0; column < stops.size(); ++column) {
+                    const auto& time = times[row * stops.size() + column];
+                    expected_count += time && *time <= max_time;
+                }
+                ASSERT_EQUAL(reachable.size(), expected_count);
+                for (size_t k = 0; k < reachable.size(); ++k) {
+                    ASSERT(k == 0 || reachable[k - 1].time <= reachable[k].time);
+                    const size_t column = std::find(stops.begin(), stops.end(), reachable[k].name) - stops.begin();
+                    ASSERT(column < stops.size());
+                    ASSERT(IsNear(reachable[k].time, *times[row * stops.size() + column], tolerance));
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void TestTransportRouter() {
+    RUN_TEST(TestStrategiesMatchAllPairs);
+    RUN_TEST(TestRouteItems);
+    RUN_TEST(TestCompactModelEdgeCount);
+    RUN_TEST(TestPruneParallelEdges);
+    RUN_TEST(TestCompressChains);
+    RUN_TEST(TestIncrementalUpdateMatchesRebuild);
+    RUN_TEST(TestRouterReadsOwnSnapshot);
+    RUN_TEST(TestAddBusTwiceThrows);
+    RUN_TEST(TestApplyUpdates);
+    RUN_TEST(TestFixedPointWeights);
+    RUN_TEST(TestSearchStats);
+    RUN_TEST(TestBatchedRoutes);
+    RUN_TEST(TestManyToOneRoutes);
+    RUN_TEST(TestAutoStrategy);
+    RUN_TEST(TestMatrixAndIsochroneMatchRoutes);
+}
@@ -1,7 +1,9 @@
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 
 #include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 using namespace std;
 
@@ -9,105 +11,171 @@ namespace TransportCatalog {
 namespace Transport {
 
 void TransportCatalogue::AddStop(const string& name, const Geo::Coordinates& coordinates) {
-    stops_.push_back({name, coordinates});
-    stopname_to_stop_[stops_.back().name] = &stops_.back();
+    if (stopname_to_id_.count(name)) {
+        throw invalid_argument("Duplicate stop: "s + name);
+    }
+    const auto id = static_cast<Domain::StopId>(stops_.size());
+    stops_.push_back({id, name, coordinates});
+    stopname_to_id_[stops_.back().name] = id;
+    stop_to_buses_.emplace_back();
 }
 
 const Domain::Stop* TransportCatalogue::FindStop(const std::string_view name) const {
-    if (stopname_to_stop_.count(name)) {
-        return stopname_to_stop_.at(name);
+    if (auto it = stopname_to_id_.find(name); it != stopname_to_id_.end()) {
+        return &stops_[it->second];
     }
     return nullptr;
 }
 
-void TransportCatalogue::AddBus(const std::string& name, const std::vector<std::string>& stops, const bool is_circular) { 
-    buses_.push_back({name, {}, is_circular}); 
-    auto& bus_stops = buses_.back().stops; 
-    bus_stops.reserve(stops.size()); 
-    for (const auto& stop_name : stops) { 
-        bus_stops.push_back(stopname_to_stop_.at(stop_name)); 
-    } 
-    busname_to_bus_[buses_.back().name] = &buses_.back(); 
+const Domain::Stop& TransportCatalogue::GetStop(Domain::StopId id) const {
+    return stops_.at(id);
+}
+
+void TransportCatalogue::AddBus(const std::string& name, const std::vector<std::string>& stops, const bool is_circular) {
+    if (busname_to_id_.count(name)) {
+        throw invalid_argument("Duplicate bus: "s + name);
+    }
+    std::vector<Domain::StopId> bus_stops;
+    bus_stops.reserve(stops.size());
     for (const auto& stop_name : stops) {
-        stop_to_buses_[stopname_to_stop_.at(stop_name)].insert(buses_.back().name); 
-    } 
-} 
+        bus_stops.push_back(stopname_to_id_.at(stop_name));
+    }
+
+    const auto id = static_cast<Domain::BusId>(buses_.size());
+    buses_.push_back({id, name, std::move(bus_stops), is_circular});
+    busname_to_id_[buses_.back().name] = id;
+    // Автобус добавляется в списки остановок последним, так что повтор
+    // остановки в маршруте виден по концу списка
+    for (const Domain::StopId stop : buses_.back().stops) {
+        auto& stop_buses = stop_to_buses_[stop];
+        if (stop_buses.empty() || stop_buses.back() != id) {
+            stop_buses.push_back(id);
+        }
+    }
+    std::lock_guard guard(bus_info_mutex_);
+    bus_info_cache_.resize(buses_.size());
+}
 
 const Domain::Bus* TransportCatalogue::FindBus(const std::string_view name) const {
-    if (busname_to_bus_.count(name)) {
-        return busname_to_bus_.at(name);
+    if (auto it = busname_to_id_.find(name); it != busname_to_id_.end()) {
+        return &buses_[it->second];
     }
     return nullptr;
 }
 
+const Domain::Bus& TransportCatalogue::GetBus(Domain::BusId id) const {
+    return buses_.at(id);
+}
+
 const Domain::BusInfo TransportCatalogue::GetBusInfo(const std::string_view name) const {
-    Domain::BusInfo info;
-    if (const auto* bus = FindBus(name); bus) {
-        set<string> unique_stops;
-        info.stops_on_route = bus->is_circular ? bus->stops.size() : bus->stops.size() * 2 - 1;
-        size_t last_stop = bus->is_circular ? bus->stops.size() - 1 : bus->stops.size() - 1;
-            
-            for (size_t i = 0; i < last_stop; ++i) {
-                int distance = GetDistance(bus->stops[i], bus->stops[i + 1]);
-                if (distance == 0) {
-                    distance = GetDistance(bus->stops[i + 1], bus->stops[i]);
-                }
-                info.route_length += distance;
-                info.geo_length += ComputeDistance(bus->stops[i]->coordinates, bus->stops[i + 1]->coordinates);
-                unique_stops.insert(bus->stops[i]->name);
-            }
-            unique_stops.insert(bus->stops[last_stop]->name);
-
-            if (!bus->is_circular) {
-                for (size_t i = last_stop; i > 0; --i) {
-                    int distance = GetDistance(bus->stops[i], bus->stops[i - 1]);
-                    if (distance == 0) {
-                        distance = GetDistance(bus->stops[i - 1], bus->stops[i]);
-                    }
-                    info.route_length += distance;
-                    info.geo_length += ComputeDistance(bus->stops[i]->coordinates, bus->stops[i - 1]->coordinates);
-                }
-            }
-
-            info.unique_stops = unique_stops.size();
-            if (info.geo_length > 0) {
-                info.curvature = info.route_length / info.geo_length;
-            } else {
-                info.curvature = 1;
-            }
+    const auto* bus = FindBus(name);
+    if (!bus) {
+        return {};
+    }
+    uint64_t version = 0;
+    {
+        std::lock_guard guard(bus_info_mutex_);
+        const CachedBusInfo& cached = bus_info_cache_[bus->id];
+        if (cached.info) {
+            return *cached.info;
+        }
+        version = cached.version;
+    }
+    // Считаем без блокировки: при гонке два потока получат одинаковый результат.
+    // Если за это время SetDistance сбросил автобус, результат не сохраняется.
+    const Domain::BusInfo info = ComputeBusInfo(*bus);
+    std::lock_guard guard(bus_info_mutex_);
+    CachedBusInfo& cached = bus_info_cache_[bus->id];
+    if (cached.version == version) {
+        cached.info = info;
     }
     return info;
 }
 
-const std::set<std::string_view>& TransportCatalogue::GetBusesByStop(const std::string& stop_name) const { 
-    static std::set<std::string_view> empty_set;
-    if (const auto* stop = FindStop(stop_name); stop && stop_to_buses_.count(stop) > 0) {  
-        return stop_to_buses_.at(stop); 
-    } else { 
-        return empty_set;  
-    } 
-} 
+Domain::BusInfo TransportCatalogue::ComputeBusInfo(const Domain::Bus& bus) const {
+    Domain::BusInfo info;
+    std::vector<Domain::StopId> unique_stops = bus.stops;
+    std::sort(unique_stops.begin(), unique_stops.end());
+    info.stops_on_route = bus.is_circular ? bus.stops.size() : bus.stops.size() * 2 - 1;
+    info.unique_stops = std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
+
+    // GetDistance сам дает обратное расстояние, если прямое не задано
+    for (size_t i = 1; i < bus.stops.size(); ++i) {
+        const Domain::StopId from = bus.stops[i - 1];
+        const Domain::StopId to = bus.stops[i];
+        const double geo_distance = ComputeDistance(stops_[from].coordinates, stops_[to].coordinates);
+        info.route_length += GetDistance(from, to);
+        info.geo_length += geo_distance;
+        if (!bus.is_circular) {
+            info.route_length += GetDistance(to, from);
+            info.geo_length += geo_distance;
+        }
+    }
 
-void TransportCatalogue::SetDistance(const Domain::Stop* from, const Domain::Stop* to, int distance) {
-    distances_[{from, to}] = distance;
+    if (info.geo_length > 0) {
+        info.curvature = info.route_length / info.geo_length;
+    } else {
+        info.curvature = 1;
+    }
+    return info;
+}
+
+// Проходит ли автобус перегон между остановками в любом направлении
+bool TransportCatalogue::HasSegment(const Domain::Bus& bus, Domain::StopId from, Domain::StopId to) {
+    for (size_t i = 1; i < bus.stops.size(); ++i) {
+        if ((bus.stops[i - 1] == from && bus.stops[i] == to) || (bus.stops[i - 1] == to && bus.stops[i] == from)) {
+            return true;
+        }
+    }
+    return false;
 }
 
-int TransportCatalogue::GetDistance(const Domain::Stop* from, const Domain::Stop* to) const {
-    if (auto it = distances_.find({from, to}); it != distances_.end()) {
-        return it->second;
+std::set<std::string_view> TransportCatalogue::GetBusesByStop(const std::string& stop_name) const {
+    std::set<std::string_view> buses;
+    if (const auto* stop = FindStop(stop_name)) {
+        for (const Domain::BusId bus : stop_to_buses_[stop->id]) {
+            buses.insert(buses_[bus].name);
+        }
     }
-    if (auto it = distances_.find({to, from}); it != distances_.end()) {
-        return it->second;
+    return buses;
+}
+
+const std::vector<Domain::BusId>& TransportCatalogue::GetBusIdsByStop(Domain::StopId stop) const {
+    return stop_to_buses_.at(stop);
+}
+
+void TransportCatalogue::SetDistance(Domain::StopId from, Domain::StopId to, int distance) {
+    distances_.Set(from, to, distance);
+
+    // Расстояние в одну сторону служит и обратным, если то не задано,
+    // поэтому сбрасываем автобусы, проходящие перегон в любом направлении
+    std::lock_guard guard(bus_info_mutex_);
+    for (const Domain::BusId bus : stop_to_buses_.at(from)) {
+        if (HasSegment(buses_[bus], from, to)) {
+            bus_info_cache_[bus].info.reset();
+            ++bus_info_cache_[bus].version;
+        }
     }
-    return 0;
 }
 
-const std::unordered_map<std::string_view, const Domain::Stop*>& TransportCatalogue::GetAllStops() const {
-    return stopname_to_stop_;
+int TransportCatalogue::GetDistance(Domain::StopId from, Domain::StopId to) const {
+    return distances_.Get(from, to);
+}
+
+const std::deque<Domain::Stop>& TransportCatalogue::GetAllStops() const {
+    return stops_;
+}
+
+const std::deque<Domain::Bus>& TransportCatalogue::GetAllBuses() const {
+    return buses_;
+}
+
+const DistanceTable& TransportCatalogue::GetDistanceTable() const {
+    return distances_;
 }
-    
-const std::unordered_map<std::string_view, const Domain::Bus*>& TransportCatalogue::GetAllBuses() const {
-    return busname_to_bus_;
+
+std::shared_ptr<const CatalogueSnapshot> TransportCatalogue::Freeze() const {
+    return std::make_shared<const CatalogueSnapshot>(*this);
 }
 } // namespace Transport
-} // namespace TransportCatalog
\ No newline at end of file
+} // namespace TransportCatalog
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "domain.h"
+#include "distance_table.h"
 
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <set>
@@ -14,53 +18,83 @@
 namespace TransportCatalog {
 namespace Transport {
 
+class CatalogueSnapshot;
+
+// Остановки и автобусы хранятся по номерам Domain::StopId и Domain::BusId;
+// поиск по имени нужен только на входе запросов.
 class TransportCatalogue {
 public:
-    // Добавляет остановку
+    // Добавляет остановку; std::invalid_argument, если имя уже занято
     void AddStop(const std::string& name, const Geo::Coordinates& coordinates);
-    
+
     // Ищет остановку
     const Domain::Stop* FindStop(const std::string_view name) const;
-    
-    // Добавляет маршрут автобуса
+
+    // Остановка по номеру
+    const Domain::Stop& GetStop(Domain::StopId id) const;
+
+    // Добавляет маршрут автобуса; std::invalid_argument, если имя уже занято
     void AddBus(const std::string& name, const std::vector<std::string>& stops, const bool is_circular);
-    
+
     // Ищет маршрут автобуса
     const Domain::Bus* FindBus(const std::string_view name) const;
-    
-    // Выдает информацию о маршрутах автобусов
+
+    // Автобус по номеру
+    const Domain::Bus& GetBus(Domain::BusId id) const;
+
+    // Выдает информацию о маршрутах автобусов. Результат считается один раз
+    // на автобус и хранится до изменения расстояния на одном из его перегонов;
+    // можно вызывать из нескольких потоков одновременно.
     const Domain::BusInfo GetBusInfo(const std::string_view name) const;
-    
-    // Получение списка автобусов, проходящих через остановку
-    const std::set<std::string_view>& GetBusesByStop(const std::string& stop_name) const;
-    
-    // Задает расстояние между остановками
-    void SetDistance(const Domain::Stop* from, const Domain::Stop* to, int distance);
-    
-    // Получает расстояние между остановками
-    int GetDistance(const Domain::Stop* from, const Domain::Stop* to) const;
-
-    const std::unordered_map<std::string_view, const Domain::Stop*>& GetAllStops() const;
-    
-    const std::unordered_map<std::string_view, const Domain::Bus*>& GetAllBuses() const;
+
+    // Получение списка автобусов, проходящих через остановку, по именам
+    std::set<std::string_view> GetBusesByStop(const std::string& stop_name) const;
+
+    // Номера автобусов, проходящих через остановку, в порядке добавления
+    const std::vector<Domain::BusId>& GetBusIdsByStop(Domain::StopId stop) const;
+
+    // Задает расстояние между остановками и сбрасывает сохраненную
+    // информацию об автобусах, проходящих этот перегон
+    void SetDistance(Domain::StopId from, Domain::StopId to, int distance);
+
+    // Получает расстояние между остановками или обратное, если прямое не задано
+    int GetDistance(Domain::StopId from, Domain::StopId to) const;
+
+    // Все остановки и автобусы; номер элемента совпадает с его id
+    const std::deque<Domain::Stop>& GetAllStops() const;
+
+    const std::deque<Domain::Bus>& GetAllBuses() const;
+
+    const DistanceTable& GetDistanceTable() const;
+
+    // Неизменяемая копия текущего состояния для читающих потоков;
+    // дальнейшие изменения справочника ее не затрагивают
+    std::shared_ptr<const CatalogueSnapshot> Freeze() const;
 private:
+    Domain::BusInfo ComputeBusInfo(const Domain::Bus& bus) const;
+    static bool HasSegment(const Domain::Bus& bus, Domain::StopId from, Domain::StopId to);
+
     std::deque<Domain::Stop> stops_;
-    std::unordered_map<std::string_view, const Domain::Stop*> stopname_to_stop_;
+    std::unordered_map<std::string_view, Domain::StopId> stopname_to_id_;
 
     std::deque<Domain::Bus> buses_;
-    std::unordered_map<std::string_view, const Domain::Bus*> busname_to_bus_;
-
-    std::unordered_map<const Domain::Stop*, std::set<std::string_view>> stop_to_buses_;
-
-	struct StopPairHasher {
-		size_t operator()(const std::pair<const Domain::Stop*, const Domain::Stop*>& pair) const {
-			std::hash<const void*> hasher;
-			size_t first = hasher(pair.first);
-			size_t second = hasher(pair.second);
-			return first + 37 * second;
-		}
-	};
-    std::unordered_map<std::pair<const Domain::Stop*, const Domain::Stop*>, int, StopPairHasher> distances_;
+    std::unordered_map<std::string_view, Domain::BusId> busname_to_id_;
+
+    // Индексируется StopId
+    std::vector<std::vector<Domain::BusId>> stop_to_buses_;
+
+    DistanceTable distances_;
+
+    // Сохраненная информация об автобусе. Версия растет при каждом сбросе:
+    // результат, посчитанный до сброса, по ней узнается и не сохраняется
+    struct CachedBusInfo {
+        std::optional<Domain::BusInfo> info;
+        uint64_t version = 0;
+    };
+
+    mutable std::mutex bus_info_mutex_;
+    // Индексируется BusId
+    mutable std::vector<CachedBusInfo> bus_info_cache_;
 };
 } // namespace Transport
-} // namespace TransportCatalog
\ No newline at end of file
+} // namespace TransportCatalog
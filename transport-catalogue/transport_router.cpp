@@ -1,65 +1,588 @@
 #include "transport_router.h"
+#include "parallel.h"
 
-TransportRouter::TransportRouter(const TransportCatalog::Transport::TransportCatalogue& db, int bus_wait_time, double bus_velocity)
-    : db_(db), bus_wait_time_(bus_wait_time), bus_velocity_(bus_velocity * 1000 / 60)  // км/ч -> м/мин
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+TransportRouter::TransportRouter(std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot> db,
+                                 const RoutingSettings& settings)
+    : db_(std::move(db))
+    , settings_(settings)
+    , bus_wait_time_(settings.bus_wait_time)
+    , bus_velocity_(settings.bus_velocity * 1000 / 60)  // км/ч -> м/мин
 {
-    BuildGraph();
-    router_ = std::make_unique<graph::Router<double>>(graph_);
+    std::vector<const Domain::Bus*> buses;
+    buses.reserve(db_->GetAllBuses().size());
+    for (const Domain::Bus& bus : db_->GetAllBuses()) {
+        buses.push_back(&bus);
+    }
+    BuildGraph(buses);
+    BuildEngine();
+}
+
+TransportRouter::TransportRouter(const TransportCatalog::Transport::TransportCatalogue& db, const RoutingSettings& settings)
+    : TransportRouter(db.Freeze(), settings) {
 }
 
-void TransportRouter::BuildGraph() {
-    size_t vertex_count = 2 * db_.GetAllStops().size();
-    graph_ = graph::DirectedWeightedGraph<double>(vertex_count);
+void TransportRouter::BuildEngine() {
+    router_.reset();
+    dijkstra_router_.reset();
+    fixed_point_router_.reset();
+    backward_router_.reset();
+    fixed_point_backward_router_.reset();
+    tree_cache_.reset();
+    landmarks_.reset();
+    contraction_hierarchy_.reset();
+    all_pairs_table_.reset();
+
+    if (settings_.heuristic == RoutingSettings::Heuristic::GEO) {
+        geo_heuristic_scale_ = ComputeGeoHeuristicScale();
+    }
+    const bool is_auto = settings_.strategy == RoutingSettings::Strategy::AUTO;
+    strategy_ = is_auto ? ChooseStrategy() : settings_.strategy;
+    size_t tree_cache_bytes = settings_.tree_cache_bytes;
+    if (is_auto && strategy_ == RoutingSettings::Strategy::DIJKSTRA && tree_cache_bytes == 0) {
+        tree_cache_bytes = GetAutoTreeCacheBytes();
+    }
+    if (settings_.log_stats) {
+        std::cerr << "Routing strategy: " << GetStrategyName(strategy_) << (is_auto ? " (auto)" : "")
+                  << ", estimated memory " << EstimateMemoryUsage(strategy_, tree_cache_bytes) / double(1 << 20)
+                  << " MB for " << graph_.GetVertexCount() << " vertices and " << graph_.GetEdgeCount() << " edges";
+        if (is_auto) {
+            std::cerr << ", budget " << settings_.memory_budget_bytes / double(1 << 20) << " MB";
+        }
+        std::cerr << std::endl;
+    }
+
+    switch (strategy_) {
+    case RoutingSettings::Strategy::AUTO:
+        throw std::logic_error("Routing strategy is not chosen");
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        router_ = std::make_unique<graph::Router<double>>(graph_);
+        break;
+    case RoutingSettings::Strategy::DIJKSTRA:
+        if (settings_.fixed_point_weights) {
+            fixed_point_router_ = std::make_unique<graph::DijkstraRouter<uint32_t, double>>(
+                graph_, graph::CsrDirection::OUTGOING, ToFixedPoint);
+            fixed_point_backward_router_ = std::make_unique<graph::DijkstraRouter<uint32_t, double>>(
+                graph_, graph::CsrDirection::INCOMING, ToFixedPoint);
+        } else {
+            dijkstra_router_ = std::make_unique<graph::DijkstraRouter<double>>(graph_);
+            backward_router_ = std::make_unique<graph::DijkstraRouter<double>>(graph_, graph::CsrDirection::INCOMING);
+        }
+        if (settings_.heuristic == RoutingSettings::Heuristic::LANDMARKS) {
+            BuildLandmarks();
+        }
+        if (tree_cache_bytes > 0) {
+            tree_cache_ = std::make_unique<graph::ShortestPathTreeCache<double>>(tree_cache_bytes);
+        }
+        break;
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY:
+        contraction_hierarchy_ = std::make_unique<graph::ContractionHierarchy<double>>(graph_);
+        LogContractionHierarchyStats();
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        all_pairs_table_ = std::make_unique<graph::AllPairsTable<double>>(graph_);
+        break;
+    }
+}
+
+// Таблица всех пар отвечает на запрос без поиска, но растёт как V²; поиск
+// Дейкстры не требует предрасчёта, но каждый запрос обходит граф; иерархия
+// сжатия окупается на больших графах. Берётся первая, что помещается в бюджет.
+RoutingSettings::Strategy TransportRouter::ChooseStrategy() const {
+    using Strategy = RoutingSettings::Strategy;
+    const size_t budget = settings_.memory_budget_bytes;
+    if (graph_.GetVertexCount() <= AUTO_ALL_PAIRS_MAX_VERTICES
+        && EstimateMemoryUsage(Strategy::ALL_PAIRS_COMPACT, 0) <= budget) {
+        return Strategy::ALL_PAIRS_COMPACT;
+    }
+    if (graph_.GetEdgeCount() <= AUTO_DIJKSTRA_MAX_EDGES && EstimateMemoryUsage(Strategy::DIJKSTRA, 0) <= budget) {
+        return Strategy::DIJKSTRA;
+    }
+    if (EstimateMemoryUsage(Strategy::CONTRACTION_HIERARCHY, 0) <= budget) {
+        return Strategy::CONTRACTION_HIERARCHY;
+    }
+    // В бюджет не помещается ничего: поиску Дейкстры нужно меньше всего памяти
+    return Strategy::DIJKSTRA;
+}
+
+// Кэш деревьев для DIJKSTRA, выбранной автоматически: половина бюджета,
+// оставшегося после копии графа для поиска
+size_t TransportRouter::GetAutoTreeCacheBytes() const {
+    const size_t search_bytes = EstimateMemoryUsage(RoutingSettings::Strategy::DIJKSTRA, 0);
+    return settings_.memory_budget_bytes > search_bytes ? (settings_.memory_budget_bytes - search_bytes) / 2 : 0;
+}
+
+// Оценка памяти предрасчёта стратегии без самого графа
+size_t TransportRouter::EstimateMemoryUsage(RoutingSettings::Strategy strategy, size_t tree_cache_bytes) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    const size_t edge_count = graph_.GetEdgeCount();
+    switch (strategy) {
+    case RoutingSettings::Strategy::AUTO:
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        // Ячейка устроена как Router::RouteInternalData
+        return vertex_count * vertex_count * sizeof(std::optional<std::pair<double, std::optional<graph::EdgeId>>>);
+    case RoutingSettings::Strategy::DIJKSTRA: {
+        // Копии графа для прямого и обратного поиска
+        const size_t weight_size = settings_.fixed_point_weights ? sizeof(uint32_t) : sizeof(double);
+        return 2 * ((vertex_count + 1) * sizeof(size_t)
+                    + edge_count * (sizeof(graph::VertexId) + weight_size + sizeof(graph::EdgeId)))
+            + tree_cache_bytes;
+    }
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY:
+        return edge_count * CONTRACTION_HIERARCHY_BYTES_PER_EDGE;
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        return vertex_count * vertex_count * (sizeof(float) + sizeof(uint32_t));
+    }
+    return 0;
+}
+
+const char* TransportRouter::GetStrategyName(RoutingSettings::Strategy strategy) {
+    switch (strategy) {
+    case RoutingSettings::Strategy::AUTO:
+        return "auto";
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        return "all_pairs";
+    case RoutingSettings::Strategy::DIJKSTRA:
+        return "dijkstra";
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY:
+        return "contraction_hierarchy";
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        return "all_pairs_compact";
+    }
+    return "";
+}
+
+void TransportRouter::LogContractionHierarchyStats() const {
+    if (!settings_.log_stats) {
+        return;
+    }
+    const auto& stats = contraction_hierarchy_->GetStats();
+    std::cerr << "Contraction hierarchy: " << graph_.GetVertexCount() << " vertices, "
+              << graph_.GetEdgeCount() << " edges, " << stats.shortcut_count << " shortcuts, "
+              << stats.round_count << " rounds, " << stats.preprocessing_seconds << " s" << std::endl;
+}
+
+void TransportRouter::BuildLandmarks() {
+    std::vector<graph::VertexId> stop_vertices;
+    stop_vertices.reserve(stop_to_vertex_.size());
+    for (graph::VertexId vertex = 0; vertex < vertex_to_stop_.size(); ++vertex) {
+        if (IsStopVertex(vertex)) {
+            stop_vertices.push_back(vertex);
+        }
+    }
+    landmarks_ = std::make_unique<graph::LandmarkBounds<double>>(graph_, stop_vertices, settings_.landmark_count);
+}
+
+// Округление вверх: целый вес пути не меньше точного, поэтому нижние оценки
+// A*, посчитанные по точным весам, остаются допустимыми
+uint32_t TransportRouter::ToFixedPoint(double weight) {
+    const double scaled = std::ceil(weight * FIXED_POINT_SCALE);
+    if (!(scaled <= std::numeric_limits<uint32_t>::max())) {
+        throw std::out_of_range("Edge weight is too large for fixed-point weights");
+    }
+    return static_cast<uint32_t>(std::max(0.0, scaled));
+}
+
+uint32_t TransportRouter::ToFixedPointBound(double estimate) {
+    const double scaled = std::floor(estimate * FIXED_POINT_SCALE);
+    return static_cast<uint32_t>(std::clamp(scaled, 0.0, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+}
+
+// В граф попадают только автобусы buses: автобусы снимка, ещё не
+// переданные в AddBus, остаются вне графа и при его перестроении
+void TransportRouter::BuildGraph(const std::vector<const Domain::Bus*>& buses) {
+    graph_ = {};
+    stop_to_vertex_.clear();
+    vertex_to_stop_.clear();
+    vertex_coordinates_.clear();
+    edge_info_.clear();
+    bus_graphs_.clear();
+    bus_to_index_.assign(db_->GetAllBuses().size(), NO_BUS_INDEX);
+    stop_to_vertex_.assign(db_->GetAllStops().size(), NO_VERTEX);
+    is_chain_stop_.clear();
+    chain_stops_.clear();
+    chain_stop_count_ = 0;
+
+    if (settings_.compress_chains) {
+        FindChainStops(buses);
+    }
+    for (const Domain::Stop& stop : db_->GetAllStops()) {
+        if (!IsChainStop(stop.id)) {
+            AddStopVertices(stop);
+        }
+    }
+    for (const Domain::Bus* bus : buses) {
+        bus_to_index_[bus->id] = bus_graphs_.size();
+        bus_graphs_.push_back({bus, AddBusVertices(*bus), 0, 0});
+    }
+    for (const BusGraph& bus_graph : bus_graphs_) {
+        BuildChainStops(bus_graph);
+    }
+
+    const auto bus_edges = BuildAllBusEdges();
+    if (!settings_.prune_parallel_edges) {
+        for (size_t index = 0; index < bus_graphs_.size(); ++index) {
+            AddBusEdges(index, bus_edges[index]);
+        }
+        return;
+    }
 
-    size_t vertex_id = 0;
-    for (const auto& [stop_name, _] : db_.GetAllStops()) {
-        stop_to_vertex_[stop_name] = vertex_id;
-        vertex_to_stop_.push_back(stop_name);
-        vertex_to_stop_.push_back(stop_name);
+    size_t candidate_count = 0;
+    for (const auto& edges : bus_edges) {
+        candidate_count += edges.size();
+    }
+    first_pruned_edge_ = graph_.GetEdgeCount();
+    for (const auto& [edge, info] : SelectCheapestParallelEdges(bus_edges)) {
+        graph_.AddEdge(edge);
+        edge_info_.push_back(info);
+    }
+    if (settings_.log_stats) {
+        std::cerr << "Parallel edge pruning: kept " << graph_.GetEdgeCount() - first_pruned_edge_
+                  << " of " << candidate_count << " bus edges" << std::endl;
+    }
+}
 
-        graph_.AddEdge({vertex_id, vertex_id + 1, static_cast<double>(bus_wait_time_)});
-        vertex_id += 2;
+// Автобусы графа по возрастанию номера, как при построении
+std::vector<const Domain::Bus*> TransportRouter::GetRoutedBuses() const {
+    std::vector<const Domain::Bus*> buses;
+    buses.reserve(bus_graphs_.size());
+    for (const BusGraph& bus_graph : bus_graphs_) {
+        buses.push_back(bus_graph.bus);
     }
+    std::sort(buses.begin(), buses.end(), [](const Domain::Bus* lhs, const Domain::Bus* rhs) {
+        return lhs->id < rhs->id;
+    });
+    return buses;
+}
 
-    for (const auto& [_, bus] : db_.GetAllBuses()) {
+// Проходная остановка встречается во всех маршрутах ровно один раз и не на
+// концах маршрута. У кольцевого маршрута первая остановка повторяется
+// в конце, поэтому она проходной не бывает.
+void TransportRouter::FindChainStops(const std::vector<const Domain::Bus*>& buses) {
+    const size_t stop_count = db_->GetAllStops().size();
+    std::vector<size_t> occurrences(stop_count, 0);
+    for (const Domain::Bus* bus : buses) {
+        for (const Domain::StopId stop : bus->stops) {
+            ++occurrences[stop];
+        }
+    }
+    is_chain_stop_.assign(stop_count, false);
+    chain_stops_.resize(stop_count);
+    for (const Domain::Bus* bus : buses) {
         const auto& stops = bus->stops;
-        size_t last_stop_idx = stops.size();
-        if (!bus->is_circular) {
-            last_stop_idx--;
-        }
-        for (size_t i = 0; i < last_stop_idx; ++i) {
-            for (size_t j = i + 1; j <= last_stop_idx; ++j) {
-                // Прямое направление
-                double distance = 0;
-                for (size_t k = i; k < j; ++k) {
-                    distance += db_.GetDistance(stops[k], stops[(k + 1) % stops.size()]);
-                }
-                double time = distance / bus_velocity_;
-                size_t from_vertex = stop_to_vertex_[stops[i]->name] + 1;
-                size_t to_vertex = stop_to_vertex_[stops[j % stops.size()]->name];
-                graph_.AddEdge({from_vertex, to_vertex, time});
-
-                // Обратное направление (только если маршрут не кольцевой)
-                if (!bus->is_circular) {
-                    double reverse_distance = 0;
-                    for (size_t k = j; k > i; --k) {
-                        reverse_distance += db_.GetDistance(stops[k % stops.size()], stops[(k - 1) % stops.size()]);
-                    }
-                    double reverse_time = reverse_distance / bus_velocity_;
-                    size_t reverse_from_vertex = stop_to_vertex_[stops[j % stops.size()]->name] + 1;
-                    size_t reverse_to_vertex = stop_to_vertex_[stops[i]->name];
-                    graph_.AddEdge({reverse_from_vertex, reverse_to_vertex, reverse_time});
-                }
+        for (size_t k = 1; k + 1 < stops.size(); ++k) {
+            if (occurrences[stops[k]] == 1) {
+                is_chain_stop_[stops[k]] = true;
+                ++chain_stop_count_;
+            }
+        }
+    }
+    if (settings_.log_stats) {
+        std::cerr << "Chain compression: removed " << chain_stop_count_ << " of "
+                  << db_->GetAllStops().size() << " stops" << std::endl;
+    }
+}
+
+// Заполняет связи проходных остановок автобуса с вершинами графа. Вершины
+// позиций компактной модели нумеруются так же, как в AddBusVertices.
+void TransportRouter::BuildChainStops(const BusGraph& bus_graph) {
+    if (chain_stop_count_ == 0) {
+        return;
+    }
+    const Domain::Bus& bus = *bus_graph.bus;
+    for (const Domain::StopId stop : bus.stops) {
+        if (IsChainStop(stop)) {
+            chain_stops_[stop].clear();
+        }
+    }
+
+    const bool pairwise = settings_.graph_model == RoutingSettings::GraphModel::PAIRWISE;
+    const auto directions = GetBusDirections(bus);
+    graph::VertexId first_vertex = bus_graph.first_vertex;
+    for (size_t direction = 0; direction < directions.size(); ++direction) {
+        const auto& stops = directions[direction];
+        const auto offsets = GetDirectionOffsets(stops);
+        const auto positions = GetGraphPositions(stops);
+
+        // В попарной модели поездка из проходной остановки заканчивается
+        // в вершине ожидания остановки графа, а поездка в проходную начинается
+        // с вершины посадки — ожидание на остановке графа уже учтено
+        std::vector<graph::VertexId> ride_end_vertices(positions.size());
+        std::vector<graph::VertexId> ride_start_vertices(positions.size());
+        for (size_t index = 0; index < positions.size(); ++index) {
+            if (pairwise) {
+                ride_end_vertices[index] = stop_to_vertex_[stops[positions[index]]];
+                ride_start_vertices[index] = ride_end_vertices[index] + 1;
+            } else {
+                ride_end_vertices[index] = ride_start_vertices[index] = first_vertex + index;
+            }
+        }
+
+        size_t next = 0;  // первая позиция графа после текущей остановки
+        for (size_t k = 0; k < stops.size(); ++k) {
+            if (next < positions.size() && positions[next] == k) {
+                ++next;
+                continue;
+            }
+            ChainStop chain_stop{&bus, direction, k, offsets[k], {}, {}};
+            // Компактной модели достаточно соседних позиций: дальше по
+            // автобусу ведут рёбра поездки
+            const size_t first_boarding = next;
+            const size_t last_boarding = pairwise ? positions.size() : next + 1;
+            for (size_t index = first_boarding; index < last_boarding; ++index) {
+                const size_t position = positions[index];
+                chain_stop.boardings.push_back({ride_end_vertices[index], offsets[position] - offsets[k],
+                                                static_cast<int>(position - k)});
+            }
+            const size_t first_alighting = pairwise ? 0 : next - 1;
+            for (size_t index = first_alighting; index < next; ++index) {
+                const size_t position = positions[index];
+                chain_stop.alightings.push_back({ride_start_vertices[index], offsets[k] - offsets[position],
+                                                 static_cast<int>(k - position)});
+            }
+            chain_stops_[stops[k]].push_back(std::move(chain_stop));
+        }
+        if (!pairwise) {
+            first_vertex += positions.size();
+        }
+    }
+}
+
+bool TransportRouter::IsChainStop(Domain::StopId stop) const {
+    return stop < is_chain_stop_.size() && is_chain_stop_[stop];
+}
+
+bool TransportRouter::IsKnownStop(Domain::StopId stop) const {
+    return GetStopVertex(stop) != NO_VERTEX || IsChainStop(stop);
+}
+
+graph::VertexId TransportRouter::GetStopVertex(Domain::StopId stop) const {
+    return stop < stop_to_vertex_.size() ? stop_to_vertex_[stop] : NO_VERTEX;
+}
+
+// Номер остановки из запроса; остановка должна быть в графе или быть проходной
+Domain::StopId TransportRouter::FindKnownStop(std::string_view stop_name) const {
+    const Domain::Stop* stop = db_->FindStop(stop_name);
+    if (!stop || !IsKnownStop(stop->id)) {
+        throw std::out_of_range("Unknown stop");
+    }
+    return stop->id;
+}
+
+// Рёбра каждого автобуса строятся в свой буфер параллельно; буферы идут
+// в порядке автобусов
+std::vector<std::vector<TransportRouter::BusEdge>> TransportRouter::BuildAllBusEdges() const {
+    std::vector<std::vector<BusEdge>> bus_edges(bus_graphs_.size());
+    thread_pool_.ForEachIndex(bus_graphs_.size(), [&](size_t index) {
+        bus_edges[index] = BuildBusEdges(bus_graphs_[index]);
+    });
+    return bus_edges;
+}
+
+// Для каждой пары вершин оставляет ребро с наименьшим весом, при равенстве
+// — первое. Пары идут в порядке первого появления, поэтому при тех же
+// маршрутах и других расстояниях порядок пар не меняется.
+std::vector<TransportRouter::BusEdge> TransportRouter::SelectCheapestParallelEdges(
+    const std::vector<std::vector<BusEdge>>& bus_edges) {
+    std::vector<BusEdge> cheapest;
+    std::unordered_map<uint64_t, size_t> pair_to_index;
+    for (const auto& edges : bus_edges) {
+        for (const BusEdge& bus_edge : edges) {
+            const uint64_t key = static_cast<uint64_t>(bus_edge.edge.from) << 32 | bus_edge.edge.to;
+            const auto [it, inserted] = pair_to_index.emplace(key, cheapest.size());
+            if (inserted) {
+                cheapest.push_back(bus_edge);
+            } else if (bus_edge.edge.weight < cheapest[it->second].edge.weight) {
+                cheapest[it->second] = bus_edge;
+            }
+        }
+    }
+    return cheapest;
+}
+
+// В попарной модели у остановки вершина ожидания и вершина посадки,
+// связанные ребром ожидания, в компактной — одна вершина
+void TransportRouter::AddStopVertices(const Domain::Stop& stop) {
+    const bool pairwise = settings_.graph_model == RoutingSettings::GraphModel::PAIRWISE;
+    const graph::VertexId vertex = graph_.AddVertex();
+    if (stop.id >= stop_to_vertex_.size()) {
+        stop_to_vertex_.resize(stop.id + 1, NO_VERTEX);
+    }
+    stop_to_vertex_[stop.id] = vertex;
+    vertex_to_stop_.push_back(stop.id);
+    vertex_coordinates_.push_back(stop.coordinates);
+    if (pairwise) {
+        graph_.AddVertex();
+        vertex_to_stop_.push_back(stop.id);
+        vertex_coordinates_.push_back(stop.coordinates);
+        const EdgeInfo info{nullptr, 0, 0.0};
+        graph_.AddEdge({vertex, vertex + 1, ComputeEdgeWeight(info)});
+        edge_info_.push_back(info);
+    }
+}
+
+// В компактной модели добавляет вершины позиций автобуса по направлениям
+// движения; возвращает первую из них
+graph::VertexId TransportRouter::AddBusVertices(const Domain::Bus& bus) {
+    const graph::VertexId first_vertex = graph_.GetVertexCount();
+    if (settings_.graph_model == RoutingSettings::GraphModel::PAIRWISE) {
+        return first_vertex;
+    }
+    for (const auto& direction : GetBusDirections(bus)) {
+        for (const size_t position : GetGraphPositions(direction)) {
+            const Domain::StopId stop = direction[position];
+            graph_.AddVertex();
+            vertex_to_stop_.push_back(stop);
+            vertex_coordinates_.push_back(db_->GetStop(stop).coordinates);
+        }
+    }
+    return first_vertex;
+}
+
+void TransportRouter::AddBusEdges(size_t bus_index, const std::vector<BusEdge>& edges) {
+    BusGraph& bus_graph = bus_graphs_[bus_index];
+    bus_graph.first_edge = graph_.GetEdgeCount();
+    bus_graph.edge_count = edges.size();
+    for (const auto& [edge, info] : edges) {
+        graph_.AddEdge(edge);
+        edge_info_.push_back(info);
+    }
+}
+
+std::vector<TransportRouter::BusEdge> TransportRouter::BuildBusEdges(const BusGraph& bus_graph) const {
+    if (settings_.graph_model == RoutingSettings::GraphModel::PAIRWISE) {
+        return BuildPairwiseBusEdges(*bus_graph.bus);
+    }
+    return BuildCompactBusEdges(*bus_graph.bus, bus_graph.first_vertex);
+}
+
+std::vector<std::vector<Domain::StopId>> TransportRouter::GetBusDirections(const Domain::Bus& bus) {
+    // Кольцевой маршрут уже заканчивается первой остановкой и идёт в одну сторону
+    std::vector<std::vector<Domain::StopId>> directions;
+    if (bus.stops.empty()) {
+        return directions;
+    }
+    directions.push_back(bus.stops);
+    if (!bus.is_circular) {
+        directions.emplace_back(bus.stops.rbegin(), bus.stops.rend());
+    }
+    return directions;
+}
+
+// Расстояния от начала направления до каждой его остановки
+std::vector<double> TransportRouter::GetDirectionOffsets(const std::vector<Domain::StopId>& stops) const {
+    std::vector<double> offsets(stops.size(), 0.0);
+    for (size_t k = 1; k < stops.size(); ++k) {
+        offsets[k] = offsets[k - 1] + db_->GetDistance(stops[k - 1], stops[k]);
+    }
+    return offsets;
+}
+
+// Номера остановок, оставшихся в графе (без проходных при сжатии цепочек)
+std::vector<size_t> TransportRouter::GetGraphPositions(const std::vector<Domain::StopId>& stops) const {
+    std::vector<size_t> positions;
+    positions.reserve(stops.size());
+    for (size_t k = 0; k < stops.size(); ++k) {
+        if (!IsChainStop(stops[k])) {
+            positions.push_back(k);
+        }
+    }
+    return positions;
+}
+
+std::vector<TransportRouter::BusEdge> TransportRouter::BuildPairwiseBusEdges(const Domain::Bus& bus) const {
+    // У кольцевого маршрута последняя остановка совпадает с первой
+    const auto& stops = bus.stops;
+    if (stops.empty()) {
+        return {};
+    }
+    const size_t last_stop_idx = stops.size() - 1;
+
+    // Префиксные суммы расстояний: путь между позициями i < j в прямом
+    // направлении равен forward[j] - forward[i], в обратном — backward[j] - backward[i]
+    std::vector<double> forward(last_stop_idx + 1, 0.0);
+    std::vector<double> backward(last_stop_idx + 1, 0.0);
+    for (size_t k = 1; k <= last_stop_idx; ++k) {
+        forward[k] = forward[k - 1] + db_->GetDistance(stops[k - 1], stops[k]);
+        backward[k] = backward[k - 1] + db_->GetDistance(stops[k], stops[k - 1]);
+    }
+
+    // Рёбра соединяют только остановки, оставшиеся в графе
+    const auto positions = GetGraphPositions(stops);
+    std::vector<graph::VertexId> vertices(last_stop_idx + 1);
+    for (const size_t position : positions) {
+        vertices[position] = stop_to_vertex_[stops[position]];
+    }
+
+    std::vector<BusEdge> edges;
+    edges.reserve(positions.size() * (positions.size() - 1) / (bus.is_circular ? 2 : 1));
+    for (size_t first = 0; first < positions.size(); ++first) {
+        for (size_t second = first + 1; second < positions.size(); ++second) {
+            const size_t i = positions[first];
+            const size_t j = positions[second];
+            const int span_count = static_cast<int>(j - i);
+
+            // Прямое направление
+            const EdgeInfo forward_info{&bus, span_count, forward[j] - forward[i]};
+            edges.push_back({{vertices[i] + 1, vertices[j], ComputeEdgeWeight(forward_info)}, forward_info});
+
+            // Обратное направление (только если маршрут не кольцевой)
+            if (!bus.is_circular) {
+                const EdgeInfo backward_info{&bus, span_count, backward[j] - backward[i]};
+                edges.push_back({{vertices[j] + 1, vertices[i], ComputeEdgeWeight(backward_info)}, backward_info});
             }
         }
     }
+    return edges;
+}
+
+// Вершины позиций одного направления идут подряд и связаны рёбрами поездки
+// на один перегон (при сжатии цепочек — до следующей позиции в графе).
+// Посадка с остановки стоит времени ожидания, высадка бесплатна. На последней
+// позиции направления посадки нет, на первой — высадки.
+std::vector<TransportRouter::BusEdge> TransportRouter::BuildCompactBusEdges(
+    const Domain::Bus& bus, graph::VertexId first_vertex) const {
+    std::vector<BusEdge> edges;
+    graph::VertexId vertex = first_vertex;
+    for (const auto& stops : GetBusDirections(bus)) {
+        const auto offsets = GetDirectionOffsets(stops);
+        const auto positions = GetGraphPositions(stops);
+        for (size_t index = 0; index + 1 < positions.size(); ++index) {
+            const size_t k = positions[index];
+            const size_t next = positions[index + 1];
+            const graph::VertexId stop_vertex = stop_to_vertex_[stops[k]];
+            const graph::VertexId next_stop_vertex = stop_to_vertex_[stops[next]];
+            const EdgeInfo board_info{nullptr, 0, 0.0};
+            const EdgeInfo ride_info{&bus, static_cast<int>(next - k), offsets[next] - offsets[k]};
+            const EdgeInfo alight_info{&bus, 0, 0.0};
+            edges.push_back({{stop_vertex, vertex + index, ComputeEdgeWeight(board_info)}, board_info});
+            edges.push_back({{vertex + index, vertex + index + 1, ComputeEdgeWeight(ride_info)}, ride_info});
+            edges.push_back({{vertex + index + 1, next_stop_vertex, ComputeEdgeWeight(alight_info)}, alight_info});
+        }
+        vertex += positions.size();
+    }
+    return edges;
 }
 
 std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(std::string_view from, std::string_view to) const {
-    size_t from_vertex = stop_to_vertex_.at(from);
-    size_t to_vertex = stop_to_vertex_.at(to);
+    const Domain::StopId from_stop = FindKnownStop(from);
+    const Domain::StopId to_stop = FindKnownStop(to);
+    const graph::VertexId from_vertex = GetStopVertex(from_stop);
+    const graph::VertexId to_vertex = GetStopVertex(to_stop);
+    if (from_vertex == NO_VERTEX || to_vertex == NO_VERTEX) {
+        return BuildAttachedRoute(from_stop, to_stop);
+    }
 
-    auto route = router_->BuildRoute(from_vertex, to_vertex);
+    auto route = BuildGraphRoute(from_vertex, to_vertex);
     if (!route) {
         return std::nullopt;
     }
@@ -67,46 +590,1008 @@ std::optional<TransportRouter::RouteInfo> TransportRouter::BuildRoute(std::strin
     return ConvertRouteToRouteInfo(*route);
 }
 
-TransportRouter::RouteInfo TransportRouter::ConvertRouteToRouteInfo(const graph::Router<double>::RouteInfo& route) const {
-    RouteInfo result;
-    result.total_time = route.weight;
+std::vector<std::optional<TransportRouter::RouteInfo>> TransportRouter::BuildRoutes(
+    const std::vector<std::pair<std::string_view, std::string_view>>& requests) const {
+    // Запросы с проходными остановками решаются по одному, остальные
+    // группируются для общих поисков
+    std::vector<std::pair<Domain::StopId, Domain::StopId>> request_stops;
+    request_stops.reserve(requests.size());
+    std::vector<size_t> graph_requests;
+    std::vector<size_t> attached_requests;
+    std::unordered_map<graph::VertexId, size_t> origin_counts;
+    std::unordered_map<graph::VertexId, size_t> destination_counts;
+    for (size_t index = 0; index < requests.size(); ++index) {
+        const auto& [from, to] = request_stops.emplace_back(FindKnownStop(requests[index].first),
+                                                            FindKnownStop(requests[index].second));
+        if (GetStopVertex(from) == NO_VERTEX || GetStopVertex(to) == NO_VERTEX) {
+            attached_requests.push_back(index);
+            continue;
+        }
+        graph_requests.push_back(index);
+        ++origin_counts[stop_to_vertex_[from]];
+        ++destination_counts[stop_to_vertex_[to]];
+    }
+
+    // Запрос попадает в группу своей вершины назначения, если их в пакете
+    // больше, чем запросов из его вершины отправления, иначе — в группу
+    // вершины отправления. Группы идут в порядке первого появления.
+    std::vector<graph::VertexId> origins;
+    std::vector<graph::VertexId> destinations;
+    std::unordered_map<graph::VertexId, std::vector<size_t>> origin_to_requests;
+    std::unordered_map<graph::VertexId, std::vector<size_t>> destination_to_requests;
+    for (const size_t index : graph_requests) {
+        const graph::VertexId from_vertex = stop_to_vertex_[request_stops[index].first];
+        const graph::VertexId to_vertex = stop_to_vertex_[request_stops[index].second];
+        const bool is_backward = strategy_ == RoutingSettings::Strategy::DIJKSTRA
+            && destination_counts.at(to_vertex) > origin_counts.at(from_vertex);
+        const graph::VertexId group_vertex = is_backward ? to_vertex : from_vertex;
+        auto& group = is_backward ? destination_to_requests[group_vertex] : origin_to_requests[group_vertex];
+        if (group.empty()) {
+            (is_backward ? destinations : origins).push_back(group_vertex);
+        }
+        group.push_back(index);
+    }
+
+    std::vector<std::optional<RouteInfo>> results(requests.size());
+    thread_pool_.ForEachIndex(origins.size() + destinations.size(), [&](size_t group_index) {
+        // Обратное дерево к вершине назначения даёт ответы на все запросы к ней
+        if (group_index >= origins.size()) {
+            const graph::VertexId to_vertex = destinations[group_index - origins.size()];
+            const auto tree = BuildBackwardTree(to_vertex);
+            for (const size_t index : destination_to_requests.at(to_vertex)) {
+                const graph::VertexId from_vertex = stop_to_vertex_[request_stops[index].first];
+                if (auto route = BuildTreeRoute(tree, from_vertex, graph::CsrDirection::INCOMING)) {
+                    results[index] = ConvertRouteToRouteInfo(*route);
+                }
+            }
+            return;
+        }
+        const graph::VertexId from_vertex = origins[group_index];
+        const auto& group = origin_to_requests.at(from_vertex);
+
+        // Дерево кратчайших путей окупается, только если запросов из вершины несколько
+        std::shared_ptr<const graph::ShortestPathTree<double>> tree;
+        if (strategy_ == RoutingSettings::Strategy::DIJKSTRA && (group.size() > 1 || tree_cache_)) {
+            tree = GetShortestPathTree(from_vertex);
+        }
+        for (const size_t index : group) {
+            const graph::VertexId to_vertex = stop_to_vertex_[request_stops[index].second];
+            auto route = tree ? BuildTreeRoute(*tree, to_vertex) : BuildGraphRoute(from_vertex, to_vertex);
+            if (route) {
+                results[index] = ConvertRouteToRouteInfo(*route);
+            }
+        }
+    });
+    thread_pool_.ForEachIndex(attached_requests.size(), [&](size_t k) {
+        const auto& [from, to] = request_stops[attached_requests[k]];
+        results[attached_requests[k]] = BuildAttachedRoute(from, to);
+    });
+    return results;
+}
+
+std::vector<std::optional<double>> TransportRouter::BuildTravelTimeMatrix(
+    const std::vector<std::string_view>& origins, const std::vector<std::string_view>& destinations) const {
+    std::vector<Domain::StopId> origin_stops;
+    origin_stops.reserve(origins.size());
+    for (const auto from : origins) {
+        origin_stops.push_back(FindKnownStop(from));
+    }
+    std::vector<Domain::StopId> destination_stops;
+    std::vector<std::vector<GraphEndpoint>> destination_endpoints;
+    destination_stops.reserve(destinations.size());
+    destination_endpoints.reserve(destinations.size());
+    for (const auto to : destinations) {
+        destination_stops.push_back(FindKnownStop(to));
+        destination_endpoints.push_back(GetTargetEndpoints(destination_stops.back()));
+    }
+
+    std::vector<std::optional<double>> times(origins.size() * destinations.size());
+    thread_pool_.ForEachIndex(origins.size(), [&](size_t row) {
+        const auto row_times = ComputeTravelTimes(origin_stops[row], destination_stops, destination_endpoints);
+        std::copy(row_times.begin(), row_times.end(), times.begin() + row * destinations.size());
+    });
+    return times;
+}
 
-    for (size_t i = 0; i < route.edges.size(); ++i) {
-        const auto& edge = graph_.GetEdge(route.edges[i]);
-        if (edge.from % 2 == 0) {
-            // Wait edge
-            result.items.push_back({RouteItem::Type::WAIT, vertex_to_stop_[edge.from], edge.weight, 0});
+std::vector<TransportRouter::ReachableStop> TransportRouter::FindReachableStops(std::string_view from, double max_time) const {
+    std::vector<ReachableStop> result;
+    const Domain::StopId from_stop = FindKnownStop(from);
+    if (chain_stop_count_ > 0) {
+        // Проходные остановки не вершины графа: считаем время до каждой остановки
+        std::vector<Domain::StopId> stops;
+        std::vector<std::vector<GraphEndpoint>> stop_endpoints;
+        for (const Domain::Stop& stop : db_->GetAllStops()) {
+            if (IsKnownStop(stop.id)) {
+                stops.push_back(stop.id);
+                stop_endpoints.push_back(GetTargetEndpoints(stop.id));
+            }
+        }
+        const auto times = ComputeTravelTimes(from_stop, stops, stop_endpoints);
+        for (size_t k = 0; k < stops.size(); ++k) {
+            if (times[k] && *times[k] <= max_time) {
+                result.push_back({db_->GetStop(stops[k]).name, *times[k]});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+            return std::tie(lhs.time, lhs.name) < std::tie(rhs.time, rhs.name);
+        });
+        return result;
+    }
+
+    // Время до каждой остановки графа по таблице или дереву поиска
+    const graph::VertexId from_vertex = stop_to_vertex_[from_stop];
+    auto add_stop_times = [&](auto get_time) {
+        for (Domain::StopId stop = 0; stop < stop_to_vertex_.size(); ++stop) {
+            if (stop_to_vertex_[stop] == NO_VERTEX) {
+                continue;
+            }
+            if (const std::optional<double> time = get_time(stop_to_vertex_[stop]); time && *time <= max_time) {
+                result.push_back({db_->GetStop(stop).name, *time});
+            }
+        }
+    };
+    switch (strategy_) {
+    case RoutingSettings::Strategy::AUTO:
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        add_stop_times([&](graph::VertexId vertex) {
+            return router_->GetRouteWeight(from_vertex, vertex);
+        });
+        break;
+    case RoutingSettings::Strategy::DIJKSTRA: {
+        // Целые веса приближённые: время берётся из дерева с точными весами.
+        // Поиск по целым весам нельзя остановить на границе max_time: вес
+        // округляется вверх на каждом ребре, и остановки у самой границы
+        // потерялись бы. Дерево зато попадает в кэш.
+        if (fixed_point_router_) {
+            const auto tree = GetShortestPathTree(from_vertex);
+            add_stop_times([&tree](graph::VertexId vertex) {
+                return tree->IsReachable(vertex) ? std::optional<double>(tree->weights[vertex]) : std::nullopt;
+            });
+            break;
+        }
+        graph::SearchStats stats;
+        for (const auto& [vertex, time] : dijkstra_router_->FindReachableVertices(from_vertex, max_time, &stats)) {
+            if (IsStopVertex(vertex)) {
+                result.push_back({db_->GetStop(vertex_to_stop_[vertex]).name, time});
+            }
+        }
+        CountSearch(stats);
+        break;
+    }
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY: {
+        // Иерархия не поддерживает поиск с ограничением: время до всех
+        // вершин даёт один проход, при немногих остановках дешевле поиск
+        // к каждой
+        graph::SearchStats stats;
+        if (UseContractionHierarchySweep(stop_to_vertex_.size())) {
+            const auto weights = contraction_hierarchy_->GetRouteWeightsFrom(from_vertex, &stats);
+            add_stop_times([&weights](graph::VertexId vertex) {
+                return weights[vertex];
+            });
         } else {
-            // Bus edge
-            const std::string_view from_stop = vertex_to_stop_[edge.from - 1];
-            const std::string_view to_stop = vertex_to_stop_[edge.to];
-                const std::string_view bus_name = FindBusBetweenStops(from_stop, to_stop);
-    int span_count = CalculateSpansBetweenStops(bus_name, from_stop, to_stop);
-            result.items.push_back({RouteItem::Type::BUS, bus_name, edge.weight, span_count});
+            add_stop_times([&](graph::VertexId vertex) {
+                return contraction_hierarchy_->GetRouteWeight(from_vertex, vertex, &stats);
+            });
         }
+        CountSearch(stats);
+        break;
+    }
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        add_stop_times([&](graph::VertexId vertex) {
+            return all_pairs_table_->GetRouteWeight(from_vertex, vertex);
+        });
+        break;
     }
 
+    std::sort(result.begin(), result.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+        return std::tie(lhs.time, lhs.name) < std::tie(rhs.time, rhs.name);
+    });
     return result;
 }
 
-std::string_view TransportRouter::FindBusBetweenStops(std::string_view from, std::string_view to) const {
-    for (const auto& [name, bus] : db_.GetAllBuses()) {
-        const auto& stops = bus->stops;
-        auto it_from = std::find_if(stops.begin(), stops.end(), [from](const Domain::Stop* stop) { return stop->name == from; });
-        auto it_to = std::find_if(stops.begin(), stops.end(), [to](const Domain::Stop* stop) { return stop->name == to; });
-        if (it_from != stops.end() && it_to != stops.end() && std::distance(it_from, it_to) > 0) {
-            return name;
+// Вершины графа, с которых начинается маршрут из остановки: сама остановка
+// или, для проходной, вершины после ожидания и поездки по её автобусу
+std::vector<TransportRouter::GraphEndpoint> TransportRouter::GetSourceEndpoints(Domain::StopId stop) const {
+    if (const graph::VertexId vertex = GetStopVertex(stop); vertex != NO_VERTEX) {
+        return {{vertex, 0.0, nullptr, 0}};
+    }
+    std::vector<GraphEndpoint> endpoints;
+    for (const ChainStop& chain_stop : chain_stops_.at(stop)) {
+        for (const auto& [vertex, distance, span_count] : chain_stop.boardings) {
+            endpoints.push_back({vertex, bus_wait_time_ + distance / bus_velocity_, chain_stop.bus, span_count});
+        }
+    }
+    return endpoints;
+}
+
+// Вершины графа, которыми заканчивается маршрут в остановку
+std::vector<TransportRouter::GraphEndpoint> TransportRouter::GetTargetEndpoints(Domain::StopId stop) const {
+    if (const graph::VertexId vertex = GetStopVertex(stop); vertex != NO_VERTEX) {
+        return {{vertex, 0.0, nullptr, 0}};
+    }
+    std::vector<GraphEndpoint> endpoints;
+    for (const ChainStop& chain_stop : chain_stops_.at(stop)) {
+        for (const auto& [vertex, distance, span_count] : chain_stop.alightings) {
+            endpoints.push_back({vertex, distance / bus_velocity_, chain_stop.bus, span_count});
+        }
+    }
+    return endpoints;
+}
+
+// Поездка без пересадок между проходными остановками одного направления
+// автобуса; в графе её нет, так как обе остановки из него убраны
+std::optional<TransportRouter::RouteInfo> TransportRouter::BuildChainRoute(Domain::StopId from, Domain::StopId to) const {
+    if (!IsChainStop(from) || !IsChainStop(to)) {
+        return std::nullopt;
+    }
+    std::optional<RouteInfo> best;
+    for (const ChainStop& from_stop : chain_stops_[from]) {
+        for (const ChainStop& to_stop : chain_stops_[to]) {
+            if (from_stop.bus != to_stop.bus || from_stop.direction != to_stop.direction
+                || from_stop.position >= to_stop.position) {
+                continue;
+            }
+            const double ride_time = (to_stop.offset - from_stop.offset) / bus_velocity_;
+            const double total_time = bus_wait_time_ + ride_time;
+            if (!best || total_time < best->total_time) {
+                const int span_count = static_cast<int>(to_stop.position - from_stop.position);
+                best = RouteInfo{total_time, {
+                    {RouteItem::Type::WAIT, db_->GetStop(from).name, static_cast<double>(bus_wait_time_), 0},
+                    {RouteItem::Type::BUS, from_stop.bus->name, ride_time, span_count},
+                }};
+            }
+        }
+    }
+    return best;
+}
+
+// Маршрут между остановками, одна из которых может быть проходной: лучший
+// из прямой поездки по цепочке и путей в графе между вершинами присоединения
+std::optional<TransportRouter::RouteInfo> TransportRouter::BuildAttachedRoute(Domain::StopId from, Domain::StopId to) const {
+    const auto sources = GetSourceEndpoints(from);
+    const auto targets = GetTargetEndpoints(to);
+    if (from == to) {
+        return RouteInfo{0.0, {}};
+    }
+
+    std::optional<RouteInfo> chain_route = BuildChainRoute(from, to);
+    std::optional<double> best_time;
+    if (chain_route) {
+        best_time = chain_route->total_time;
+    }
+    const GraphEndpoint* best_source = nullptr;
+    const GraphEndpoint* best_target = nullptr;
+    std::optional<graph::Router<double>::RouteInfo> graph_route;
+    if (strategy_ == RoutingSettings::Strategy::DIJKSTRA) {
+        // Один поиск из всех вершин присоединения; вес в дереве уже включает
+        // время от остановки до вершины, с которой начинается путь
+        const auto tree = GetSourceTree(sources);
+        for (const GraphEndpoint& target : targets) {
+            if (tree && tree->IsReachable(target.vertex)
+                && (!best_time || tree->weights[target.vertex] + target.time < *best_time)) {
+                best_time = tree->weights[target.vertex] + target.time;
+                best_target = &target;
+            }
+        }
+        if (!best_target) {
+            return chain_route;
+        }
+        graph_route = BuildTreeRoute(*tree, best_target->vertex);
+        const graph::VertexId start = graph_route->edges.empty() ? best_target->vertex
+                                                                 : graph_.GetEdge(graph_route->edges.front()).from;
+        for (const GraphEndpoint& source : sources) {
+            if (source.vertex == start && (!best_source || source.time < best_source->time)) {
+                best_source = &source;
+            }
+        }
+    } else {
+        graph::SearchStats stats;
+        for (const GraphEndpoint& source : sources) {
+            for (const GraphEndpoint& target : targets) {
+                const auto weight = GetGraphRouteWeight(nullptr, source.vertex, target.vertex, stats);
+                if (weight && (!best_time || source.time + *weight + target.time < *best_time)) {
+                    best_time = source.time + *weight + target.time;
+                    best_source = &source;
+                    best_target = &target;
+                }
+            }
+        }
+        if (strategy_ == RoutingSettings::Strategy::CONTRACTION_HIERARCHY) {
+            CountSearch(stats);
+        }
+        if (!best_source) {
+            return chain_route;
+        }
+        graph_route = BuildGraphRoute(best_source->vertex, best_target->vertex);
+    }
+
+    RouteInfo route = ConvertRouteToRouteInfo(*graph_route);
+    // Поездка от проходной остановки продолжается рёбрами поездки того же
+    // автобуса, если путь в графе с них начинается
+    if (best_source->bus) {
+        const double ride_time = best_source->time - bus_wait_time_;
+        if (!route.items.empty() && route.items.front().type == RouteItem::Type::BUS) {
+            route.items.front().time += ride_time;
+            route.items.front().span_count += best_source->span_count;
+        } else {
+            route.items.insert(route.items.begin(), {RouteItem::Type::BUS, best_source->bus->name, ride_time,
+                                                     best_source->span_count});
+        }
+        route.items.insert(route.items.begin(), {RouteItem::Type::WAIT, db_->GetStop(from).name,
+                                                 static_cast<double>(bus_wait_time_), 0});
+    }
+    if (best_target->bus) {
+        if (!route.items.empty() && route.items.back().type == RouteItem::Type::BUS) {
+            route.items.back().time += best_target->time;
+            route.items.back().span_count += best_target->span_count;
+        } else {
+            route.items.push_back({RouteItem::Type::BUS, best_target->bus->name, best_target->time,
+                                   best_target->span_count});
+        }
+    }
+    // Время посчитано так же, как в ComputeTravelTimes, и совпадает до бита
+    route.total_time = *best_time;
+    return route;
+}
+
+// Время в пути от остановки from до каждой из destinations с вершинами
+// присоединения destination_endpoints. Для DIJKSTRA строится одно дерево
+// сразу из всех вершин отправления, иерархия сжатия при достаточном числе
+// целей делает проход из каждой во все вершины. Таблицы всех пар отвечают
+// на пару вершин без поиска, поэтому для них перебираются пары.
+std::vector<std::optional<double>> TransportRouter::ComputeTravelTimes(
+    Domain::StopId from, const std::vector<Domain::StopId>& destinations,
+    const std::vector<std::vector<GraphEndpoint>>& destination_endpoints) const {
+    std::vector<std::optional<double>> times(destinations.size());
+    for (size_t column = 0; column < destinations.size(); ++column) {
+        if (destinations[column] == from) {
+            times[column] = 0.0;
+        } else if (const auto chain_route = BuildChainRoute(from, destinations[column])) {
+            times[column] = chain_route->total_time;
+        }
+    }
+
+    if (strategy_ == RoutingSettings::Strategy::DIJKSTRA) {
+        const auto tree = GetSourceTree(GetSourceEndpoints(from));
+        for (size_t column = 0; tree && column < destinations.size(); ++column) {
+            for (const GraphEndpoint& target : destination_endpoints[column]) {
+                if (tree->IsReachable(target.vertex)
+                    && (!times[column] || tree->weights[target.vertex] + target.time < *times[column])) {
+                    times[column] = tree->weights[target.vertex] + target.time;
+                }
+            }
+        }
+        return times;
+    }
+
+    size_t target_count = 0;
+    for (const auto& endpoints : destination_endpoints) {
+        target_count += endpoints.size();
+    }
+    const bool use_sweep = strategy_ == RoutingSettings::Strategy::CONTRACTION_HIERARCHY
+        && UseContractionHierarchySweep(target_count);
+
+    graph::SearchStats stats;
+    for (const GraphEndpoint& source : GetSourceEndpoints(from)) {
+        std::vector<std::optional<double>> source_weights;
+        if (use_sweep) {
+            source_weights = contraction_hierarchy_->GetRouteWeightsFrom(source.vertex, &stats);
+        }
+        for (size_t column = 0; column < destinations.size(); ++column) {
+            for (const GraphEndpoint& target : destination_endpoints[column]) {
+                const auto weight = use_sweep ? source_weights[target.vertex]
+                                              : GetGraphRouteWeight(nullptr, source.vertex, target.vertex, stats);
+                if (weight && (!times[column] || source.time + *weight + target.time < *times[column])) {
+                    times[column] = source.time + *weight + target.time;
+                }
+            }
+        }
+    }
+    if (strategy_ == RoutingSettings::Strategy::CONTRACTION_HIERARCHY) {
+        CountSearch(stats);
+    }
+    return times;
+}
+
+bool TransportRouter::UseContractionHierarchySweep(size_t target_count) const {
+    return target_count >= CH_SWEEP_MIN_TARGETS
+        && target_count * CH_SWEEP_VERTICES_PER_TARGET >= graph_.GetVertexCount();
+}
+
+// Вес пути в графе без восстановления рёбер; для DIJKSTRA берётся из дерева
+// кратчайших путей из from
+std::optional<double> TransportRouter::GetGraphRouteWeight(const graph::ShortestPathTree<double>* tree,
+                                                           graph::VertexId from, graph::VertexId to,
+                                                           graph::SearchStats& stats) const {
+    switch (strategy_) {
+    case RoutingSettings::Strategy::AUTO:
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        return router_->GetRouteWeight(from, to);
+    case RoutingSettings::Strategy::DIJKSTRA:
+        if (!tree->IsReachable(to)) {
+            return std::nullopt;
+        }
+        return tree->weights[to];
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY:
+        return contraction_hierarchy_->GetRouteWeight(from, to, &stats);
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        return all_pairs_table_->GetRouteWeight(from, to);
+    }
+    return std::nullopt;
+}
+
+bool TransportRouter::IsStopVertex(graph::VertexId vertex) const {
+    return stop_to_vertex_[vertex_to_stop_[vertex]] == vertex;
+}
+
+std::optional<graph::Router<double>::RouteInfo> TransportRouter::BuildGraphRoute(graph::VertexId from, graph::VertexId to) const {
+    switch (strategy_) {
+    case RoutingSettings::Strategy::AUTO:
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        return router_->BuildRoute(from, to);
+    case RoutingSettings::Strategy::DIJKSTRA: {
+        if (tree_cache_) {
+            return BuildTreeRoute(*GetShortestPathTree(from), to);
+        }
+        if (fixed_point_router_) {
+            return BuildFixedPointRoute(from, to);
+        }
+        graph::SearchStats stats;
+        std::optional<graph::Router<double>::RouteInfo> route;
+        if (settings_.heuristic == RoutingSettings::Heuristic::GEO) {
+            route = dijkstra_router_->BuildRouteAStar(from, to, [this, to](graph::VertexId vertex) {
+                return EstimateTimeByGeo(vertex, to);
+            }, &stats);
+        } else if (settings_.heuristic == RoutingSettings::Heuristic::LANDMARKS) {
+            route = dijkstra_router_->BuildRouteAStar(from, to, landmarks_->MakePotential(to), &stats);
+        } else {
+            route = dijkstra_router_->BuildRoute(from, to, &stats);
+        }
+        CountSearch(stats);
+        return route;
+    }
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY: {
+        graph::SearchStats stats;
+        auto route = contraction_hierarchy_->BuildRoute(from, to, &stats);
+        CountSearch(stats);
+        return route;
+    }
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        return all_pairs_table_->BuildRoute(from, to);
+    }
+    return std::nullopt;
+}
+
+// Поиск по целым весам с той же эвристикой, что и по точным; оценки
+// переводятся в миллисекунды с округлением вниз
+std::optional<graph::Router<double>::RouteInfo> TransportRouter::BuildFixedPointRoute(graph::VertexId from,
+                                                                                     graph::VertexId to) const {
+    graph::SearchStats stats;
+    std::optional<graph::Router<uint32_t>::RouteInfo> route;
+    if (settings_.heuristic == RoutingSettings::Heuristic::GEO) {
+        route = fixed_point_router_->BuildRouteAStar(from, to, [this, to](graph::VertexId vertex) {
+            return ToFixedPointBound(EstimateTimeByGeo(vertex, to));
+        }, &stats);
+    } else if (settings_.heuristic == RoutingSettings::Heuristic::LANDMARKS) {
+        const auto potential = landmarks_->MakePotential(to);
+        route = fixed_point_router_->BuildRouteAStar(from, to, [&potential](graph::VertexId vertex) {
+            return ToFixedPointBound(potential(vertex));
+        }, &stats);
+    } else {
+        route = fixed_point_router_->BuildRoute(from, to, &stats);
+    }
+    CountSearch(stats);
+    if (!route) {
+        return std::nullopt;
+    }
+    double weight = 0.0;
+    for (const graph::EdgeId edge_id : route->edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return graph::Router<double>::RouteInfo{weight, std::move(route->edges)};
+}
+
+// Дерево поиска по целым весам с точными весами путей: вес вершины
+// считается от уже посчитанного предка по рёбрам graph_. Предок в прямом
+// дереве — начало ребра, в обратном — его конец. У дерева поиска из
+// нескольких вершин sources корни получают точное время своего источника.
+graph::ShortestPathTree<double> TransportRouter::ToExactTree(graph::ShortestPathTree<uint32_t> fixed_point_tree,
+                                                             graph::CsrDirection direction,
+                                                             const std::vector<GraphEndpoint>& sources) const {
+    const bool outgoing = direction == graph::CsrDirection::OUTGOING;
+    graph::ShortestPathTree<double> tree;
+    tree.root = fixed_point_tree.root;
+    tree.other_roots = std::move(fixed_point_tree.other_roots);
+    tree.prev_edges = std::move(fixed_point_tree.prev_edges);
+    tree.weights.assign(tree.prev_edges.size(), 0.0);
+    auto parent = [&](graph::VertexId vertex) {
+        const auto& edge = graph_.GetEdge(tree.prev_edges[vertex]);
+        return outgoing ? edge.from : edge.to;
+    };
+
+    std::vector<bool> is_done(tree.prev_edges.size(), false);
+    if (sources.empty()) {
+        is_done[tree.root] = true;
+    }
+    for (const GraphEndpoint& source : sources) {
+        if (tree.prev_edges[source.vertex] == tree.NO_EDGE
+            && (!is_done[source.vertex] || source.time < tree.weights[source.vertex])) {
+            tree.weights[source.vertex] = source.time;
+            is_done[source.vertex] = true;
+        }
+    }
+    std::vector<graph::VertexId> path;
+    for (graph::VertexId vertex = 0; vertex < tree.prev_edges.size(); ++vertex) {
+        if (!tree.IsReachable(vertex)) {
+            continue;
+        }
+        for (graph::VertexId current = vertex; !is_done[current]; current = parent(current)) {
+            path.push_back(current);
+        }
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            tree.weights[*it] = tree.weights[parent(*it)] + graph_.GetEdge(tree.prev_edges[*it]).weight;
+            is_done[*it] = true;
+        }
+        path.clear();
+    }
+    return tree;
+}
+
+// Маршрут по готовому дереву: в прямом дереве — от корня до vertex,
+// в обратном — от vertex до корня
+std::optional<graph::Router<double>::RouteInfo> TransportRouter::BuildTreeRoute(
+    const graph::ShortestPathTree<double>& tree, graph::VertexId vertex, graph::CsrDirection direction) const {
+    const bool outgoing = direction == graph::CsrDirection::OUTGOING;
+    if (dijkstra_router_) {
+        return outgoing ? dijkstra_router_->BuildRoute(tree, vertex) : backward_router_->BuildRoute(tree, vertex);
+    }
+    if (!tree.IsReachable(vertex)) {
+        return std::nullopt;
+    }
+    std::vector<graph::EdgeId> edges;
+    for (graph::VertexId current = vertex; tree.prev_edges[current] != tree.NO_EDGE;) {
+        edges.push_back(tree.prev_edges[current]);
+        const auto& edge = graph_.GetEdge(edges.back());
+        current = outgoing ? edge.from : edge.to;
+    }
+    if (outgoing) {
+        std::reverse(edges.begin(), edges.end());
+    }
+    return graph::Router<double>::RouteInfo{tree.weights[vertex], std::move(edges)};
+}
+
+double TransportRouter::ComputeGeoHeuristicScale() const {
+    // Оценка допустима, если время на ребре не меньше оценки по прямой.
+    // Дорожные расстояния могут быть короче геодезических, поэтому берём
+    // наименьшее отношение дороги к прямой по всем перегонам всех автобусов.
+    double min_ratio = 1.0;
+    for (const Domain::Bus& bus : db_->GetAllBuses()) {
+        const auto& stops = bus.stops;
+        for (size_t k = 1; k < stops.size(); ++k) {
+            const double geo_distance = Geo::ComputeDistance(db_->GetStop(stops[k - 1]).coordinates,
+                                                             db_->GetStop(stops[k]).coordinates);
+            if (!(geo_distance > 0)) {
+                continue;
+            }
+            min_ratio = std::min(min_ratio, db_->GetDistance(stops[k - 1], stops[k]) / geo_distance);
+            if (!bus.is_circular) {
+                min_ratio = std::min(min_ratio, db_->GetDistance(stops[k], stops[k - 1]) / geo_distance);
+            }
+        }
+    }
+    return min_ratio / bus_velocity_;
+}
+
+double TransportRouter::EstimateTimeByGeo(graph::VertexId vertex, graph::VertexId to) const {
+    const double distance = Geo::ComputeDistance(vertex_coordinates_[vertex], vertex_coordinates_[to]);
+    double estimate = std::max(0.0, distance * geo_heuristic_scale_);
+    // Из вершины прибытия на чужую остановку дальше можно уехать только после ожидания
+    if (vertex != to && IsStopVertex(vertex)) {
+        estimate += bus_wait_time_;
+    }
+    return estimate;
+}
+
+void TransportRouter::CountSearch(const graph::SearchStats& stats) const {
+    ++searches_;
+    settled_vertices_ += stats.settled_vertices;
+}
+
+TransportRouter::SearchStats TransportRouter::GetSearchStats() const {
+    return {searches_.load(), settled_vertices_.load()};
+}
+
+TransportRouter::ExportedGraph TransportRouter::ExportGraph() const {
+    if (chain_stop_count_ > 0) {
+        throw std::logic_error("Routing graph with compressed chains cannot be exported");
+    }
+    ExportedGraph result{vertex_to_stop_, stop_to_vertex_, {}};
+    result.edges.reserve(graph_.GetEdgeCount());
+    for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const EdgeInfo& info = edge_info_[edge_id];
+        result.edges.push_back({edge.from, edge.to, edge.weight,
+                                info.bus ? std::optional<Domain::BusId>(info.bus->id) : std::nullopt, info.span_count});
+    }
+    return result;
+}
+
+std::shared_ptr<const graph::ShortestPathTree<double>> TransportRouter::GetShortestPathTree(graph::VertexId from) const {
+    if (tree_cache_) {
+        if (auto tree = tree_cache_->Find(from)) {
+            return tree;
+        }
+    }
+    graph::SearchStats stats;
+    auto tree = fixed_point_router_
+        ? std::make_shared<const graph::ShortestPathTree<double>>(
+            ToExactTree(fixed_point_router_->BuildShortestPathTree(from, &stats)))
+        : std::make_shared<const graph::ShortestPathTree<double>>(dijkstra_router_->BuildShortestPathTree(from, &stats));
+    CountSearch(stats);
+    if (tree_cache_) {
+        tree_cache_->Insert(tree);
+    }
+    return tree;
+}
+
+// Дерево поиска DIJKSTRA из остановки с вершинами присоединения sources:
+// для остановки графа — дерево из её вершины, в том числе из кэша; для
+// проходной — один поиск сразу из всех вершин, куда она довозит, со временем
+// до них как начальным весом. Такое дерево не кэшируется: ключ кэша — одна
+// вершина. nullptr, если вершин присоединения нет.
+std::shared_ptr<const graph::ShortestPathTree<double>> TransportRouter::GetSourceTree(
+    const std::vector<GraphEndpoint>& sources) const {
+    if (sources.empty()) {
+        return nullptr;
+    }
+    if (sources.size() == 1 && !sources.front().bus) {
+        return GetShortestPathTree(sources.front().vertex);
+    }
+    graph::SearchStats stats;
+    std::shared_ptr<const graph::ShortestPathTree<double>> tree;
+    if (fixed_point_router_) {
+        std::vector<graph::DijkstraRouter<uint32_t, double>::Source> seeds;
+        seeds.reserve(sources.size());
+        for (const GraphEndpoint& source : sources) {
+            seeds.emplace_back(source.vertex, ToFixedPoint(source.time));
+        }
+        tree = std::make_shared<const graph::ShortestPathTree<double>>(ToExactTree(
+            fixed_point_router_->BuildShortestPathTree(seeds, &stats), graph::CsrDirection::OUTGOING, sources));
+    } else {
+        std::vector<graph::DijkstraRouter<double>::Source> seeds;
+        seeds.reserve(sources.size());
+        for (const GraphEndpoint& source : sources) {
+            seeds.emplace_back(source.vertex, source.time);
+        }
+        tree = std::make_shared<const graph::ShortestPathTree<double>>(
+            dijkstra_router_->BuildShortestPathTree(seeds, &stats));
+    }
+    CountSearch(stats);
+    return tree;
+}
+
+// Дерево обратного поиска к вершине to: вес и первое ребро пути до to
+// из каждой вершины. В кэш не попадает — кэш хранит прямые деревья.
+graph::ShortestPathTree<double> TransportRouter::BuildBackwardTree(graph::VertexId to) const {
+    graph::SearchStats stats;
+    auto tree = fixed_point_backward_router_
+        ? ToExactTree(fixed_point_backward_router_->BuildShortestPathTree(to, &stats), graph::CsrDirection::INCOMING)
+        : backward_router_->BuildShortestPathTree(to, &stats);
+    CountSearch(stats);
+    return tree;
+}
+
+graph::ShortestPathTreeCache<double>::Stats TransportRouter::GetTreeCacheStats() const {
+    return tree_cache_ ? tree_cache_->GetStats() : graph::ShortestPathTreeCache<double>::Stats{};
+}
+
+void TransportRouter::LogQueryStats() const {
+    if (!settings_.log_stats) {
+        return;
+    }
+    const auto search_stats = GetSearchStats();
+    std::cerr << "Graph searches: " << search_stats.searches << ", settled vertices: " << search_stats.settled_vertices;
+    if (search_stats.searches > 0) {
+        std::cerr << " (" << search_stats.settled_vertices / double(search_stats.searches) << " per search)";
+    }
+    std::cerr << std::endl;
+    if (tree_cache_) {
+        const auto stats = GetTreeCacheStats();
+        std::cerr << "Tree cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+                  << " evictions, " << stats.entries << " trees, " << stats.bytes_used / double(1 << 20) << " of "
+                  << stats.bytes_limit / double(1 << 20) << " MB" << std::endl;
+    }
+}
+
+double TransportRouter::ComputeEdgeWeight(const EdgeInfo& info) const {
+    return info.bus ? info.distance / bus_velocity_ : bus_wait_time_;
+}
+
+// Пересчитывает веса всех рёбер из сохранённых расстояний без обращения
+// к справочнику; блоки рёбер обрабатываются параллельно
+TransportRouter::EdgeWeightChanges TransportRouter::CustomizeWeights() {
+    constexpr size_t BLOCK_SIZE = 4096;
+    const size_t block_count = (edge_info_.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<EdgeWeightChanges> block_changes(block_count);
+    thread_pool_.ForEachIndex(block_count, [&](size_t block) {
+        const graph::EdgeId end = std::min(edge_info_.size(), (block + 1) * BLOCK_SIZE);
+        for (graph::EdgeId edge_id = block * BLOCK_SIZE; edge_id < end; ++edge_id) {
+            const double old_weight = graph_.GetEdge(edge_id).weight;
+            const double weight = ComputeEdgeWeight(edge_info_[edge_id]);
+            if (weight != old_weight) {
+                graph_.SetEdgeWeight(edge_id, weight);
+                block_changes[block].push_back({edge_id, old_weight});
+            }
+        }
+    });
+
+    EdgeWeightChanges changes;
+    for (const auto& block : block_changes) {
+        changes.insert(changes.end(), block.begin(), block.end());
+    }
+    return changes;
+}
+
+void TransportRouter::UpdateBusEdgeWeights(size_t bus_index, EdgeWeightChanges& changes) {
+    const BusGraph& bus_graph = bus_graphs_[bus_index];
+    const auto edges = BuildBusEdges(bus_graph);
+    for (size_t k = 0; k < edges.size(); ++k) {
+        const graph::EdgeId edge_id = bus_graph.first_edge + k;
+        edge_info_[edge_id] = edges[k].info;
+        const double old_weight = graph_.GetEdge(edge_id).weight;
+        if (edges[k].edge.weight != old_weight) {
+            graph_.SetEdgeWeight(edge_id, edges[k].edge.weight);
+            changes.push_back({edge_id, old_weight});
+        }
+    }
+}
+
+TransportRouter::EdgeWeightChanges TransportRouter::ReselectPrunedEdges() {
+    EdgeWeightChanges changes;
+    const auto cheapest = SelectCheapestParallelEdges(BuildAllBusEdges());
+    for (size_t k = 0; k < cheapest.size(); ++k) {
+        const graph::EdgeId edge_id = first_pruned_edge_ + k;
+        edge_info_[edge_id] = cheapest[k].info;
+        const double old_weight = graph_.GetEdge(edge_id).weight;
+        if (cheapest[k].edge.weight != old_weight) {
+            graph_.SetEdgeWeight(edge_id, cheapest[k].edge.weight);
+            changes.push_back({edge_id, old_weight});
+        }
+    }
+    return changes;
+}
+
+const std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot>& TransportRouter::GetCatalogue() const {
+    return db_;
+}
+
+// Граф хранит указатели на автобусы снимка, поэтому они переводятся на
+// автобусы нового снимка с теми же номерами
+void TransportRouter::UpdateCatalogue(std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot> db) {
+    if (!db || db->GetAllStops().size() < db_->GetAllStops().size()
+        || db->GetAllBuses().size() < db_->GetAllBuses().size()) {
+        throw std::invalid_argument("Snapshot is not a newer version of the catalogue");
+    }
+    const auto remap = [&db](const Domain::Bus*& bus) {
+        if (bus) {
+            bus = &db->GetBus(bus->id);
+        }
+    };
+    for (EdgeInfo& info : edge_info_) {
+        remap(info.bus);
+    }
+    for (BusGraph& bus_graph : bus_graphs_) {
+        remap(bus_graph.bus);
+    }
+    for (auto& chain_stops : chain_stops_) {
+        for (ChainStop& chain_stop : chain_stops) {
+            remap(chain_stop.bus);
+        }
+    }
+    db_ = std::move(db);
+}
+
+void TransportRouter::UpdateDistance(std::string_view from, std::string_view to) {
+    const Domain::Stop* from_stop = db_->FindStop(from);
+    const Domain::Stop* to_stop = db_->FindStop(to);
+    if (!from_stop || !to_stop) {
+        throw std::out_of_range("Unknown stop");
+    }
+
+    std::vector<size_t> bus_indices;
+    for (const Domain::BusId bus : db_->GetBusIdsByStop(from_stop->id)) {
+        if (bus >= bus_to_index_.size() || bus_to_index_[bus] == NO_BUS_INDEX) {
+            continue;
+        }
+        const auto& stops = bus_graphs_[bus_to_index_[bus]].bus->stops;
+        for (size_t k = 1; k < stops.size(); ++k) {
+            if ((stops[k - 1] == from_stop->id && stops[k] == to_stop->id)
+                || (stops[k - 1] == to_stop->id && stops[k] == from_stop->id)) {
+                bus_indices.push_back(bus_to_index_[bus]);
+                break;
+            }
         }
     }
-    return {};
+
+    EdgeWeightChanges changes;
+    if (settings_.prune_parallel_edges) {
+        // Лучшее ребро пары может перейти к другому автобусу, поэтому выбор
+        // повторяется по всем автобусам; набор пар вершин от расстояний не зависит
+        if (!bus_indices.empty()) {
+            changes = ReselectPrunedEdges();
+        }
+    } else {
+        for (const size_t bus_index : bus_indices) {
+            UpdateBusEdgeWeights(bus_index, changes);
+        }
+    }
+    for (const size_t bus_index : bus_indices) {
+        BuildChainStops(bus_graphs_[bus_index]);
+    }
+    ApplyGraphChanges(changes, false);
 }
 
-int TransportRouter::CalculateSpansBetweenStops(std::string_view bus_name, std::string_view from, std::string_view to) const {
-    const auto& bus = db_.FindBus(bus_name);
-    if (!bus) return 0;
-    const auto& stops = bus->stops;
-    auto it_from = std::find_if(stops.begin(), stops.end(), [from](const Domain::Stop* stop) { return stop->name == from; });
-    auto it_to = std::find_if(stops.begin(), stops.end(), [to](const Domain::Stop* stop) { return stop->name == to; });
-    if (it_from == stops.end() || it_to == stops.end()) return 0;
-    return std::abs(std::distance(it_from, it_to));
-}
\ No newline at end of file
+void TransportRouter::AddBus(std::string_view name) {
+    const Domain::Bus* bus = db_->FindBus(name);
+    if (!bus) {
+        throw std::out_of_range("Unknown bus");
+    }
+    if (bus->id < bus_to_index_.size() && bus_to_index_[bus->id] != NO_BUS_INDEX) {
+        throw std::invalid_argument("Bus is already routed: " + bus->name);
+    }
+
+    // Новые пары вершин перемешали бы порядок лучших рёбер, а проходная
+    // остановка может стать пересадочной — граф строится заново
+    if (settings_.prune_parallel_edges || settings_.compress_chains) {
+        auto buses = GetRoutedBuses();
+        const auto by_id = [](const Domain::Bus* lhs, const Domain::Bus* rhs) {
+            return lhs->id < rhs->id;
+        };
+        buses.insert(std::upper_bound(buses.begin(), buses.end(), bus, by_id), bus);
+        BuildGraph(buses);
+        ApplyGraphChanges({}, true);
+        return;
+    }
+
+    for (const Domain::StopId stop : bus->stops) {
+        if (GetStopVertex(stop) == NO_VERTEX) {
+            AddStopVertices(db_->GetStop(stop));
+        }
+    }
+    const size_t bus_index = bus_graphs_.size();
+    if (bus->id >= bus_to_index_.size()) {
+        bus_to_index_.resize(bus->id + 1, NO_BUS_INDEX);
+    }
+    bus_to_index_[bus->id] = bus_index;
+    bus_graphs_.push_back({bus, AddBusVertices(*bus), 0, 0});
+    AddBusEdges(bus_index, BuildBusEdges(bus_graphs_[bus_index]));
+    ApplyGraphChanges({}, true);
+}
+
+// Остановка без автобусов проходной не бывает, а её ребро ожидания ложится
+// после всех рёбер автобусов, так что перестраивать граф не нужно
+void TransportRouter::AddStop(std::string_view name) {
+    const Domain::Stop* stop = db_->FindStop(name);
+    if (!stop) {
+        throw std::out_of_range("Unknown stop");
+    }
+    if (IsKnownStop(stop->id)) {
+        return;
+    }
+    AddStopVertices(*stop);
+    ApplyGraphChanges({}, true);
+}
+
+void TransportRouter::UpdateSettings(const RoutingSettings& settings) {
+    const RoutingSettings old_settings = std::exchange(settings_, settings);
+    bus_wait_time_ = settings.bus_wait_time;
+    bus_velocity_ = settings.bus_velocity * 1000 / 60;
+
+    const auto graph_settings = [](const RoutingSettings& s) {
+        return std::tie(s.graph_model, s.prune_parallel_edges, s.compress_chains);
+    };
+    if (graph_settings(settings) != graph_settings(old_settings)) {
+        BuildGraph(GetRoutedBuses());
+        BuildEngine();
+        return;
+    }
+
+    EdgeWeightChanges changes;
+    if (settings.bus_wait_time != old_settings.bus_wait_time || settings.bus_velocity != old_settings.bus_velocity) {
+        changes = CustomizeWeights();
+    }
+
+    const auto engine_settings = [](const RoutingSettings& s) {
+        return std::tie(s.strategy, s.heuristic, s.tree_cache_bytes, s.landmark_count, s.fixed_point_weights,
+                        s.memory_budget_bytes);
+    };
+    if (engine_settings(settings) != engine_settings(old_settings)) {
+        BuildEngine();
+    } else {
+        ApplyGraphChanges(changes, false);
+    }
+}
+
+// Обновляет предрасчёт стратегии после изменения графа. Без новых вершин
+// и рёбер пересчитывается только то, что зависит от изменённых весов;
+// иерархия сжатия пересжимается в прежнем порядке вершин (Recontract).
+void TransportRouter::ApplyGraphChanges(const EdgeWeightChanges& changes, bool topology_changed) {
+    if (changes.empty() && !topology_changed) {
+        return;
+    }
+    const bool has_decrease = std::any_of(changes.begin(), changes.end(), [this](const auto& change) {
+        return graph_.GetEdge(change.edge_id).weight < change.old_weight;
+    });
+
+    if (settings_.heuristic == RoutingSettings::Heuristic::GEO) {
+        geo_heuristic_scale_ = ComputeGeoHeuristicScale();
+    }
+    if (topology_changed) {
+        BuildEngine();
+        return;
+    }
+    switch (strategy_) {
+    case RoutingSettings::Strategy::AUTO:
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS:
+        // Таблица Флойда–Уоршелла пересчитывается целиком
+        BuildEngine();
+        break;
+    case RoutingSettings::Strategy::CONTRACTION_HIERARCHY:
+        contraction_hierarchy_->Recontract(graph_);
+        LogContractionHierarchyStats();
+        break;
+    case RoutingSettings::Strategy::DIJKSTRA:
+        // Оценки ALT после одного лишь удорожания рёбер остаются
+        // допустимыми, хотя и менее точными
+        if (fixed_point_router_) {
+            fixed_point_router_->UpdateWeights(ToFixedPoint);
+            fixed_point_backward_router_->UpdateWeights(ToFixedPoint);
+        } else {
+            dijkstra_router_->UpdateWeights();
+            backward_router_->UpdateWeights();
+        }
+        if (landmarks_ && has_decrease) {
+            BuildLandmarks();
+        }
+        if (tree_cache_) {
+            tree_cache_->EraseIf([&](const graph::ShortestPathTree<double>& tree) {
+                return !tree.IsValidAfter(graph_, changes);
+            });
+        }
+        break;
+    case RoutingSettings::Strategy::ALL_PAIRS_COMPACT:
+        all_pairs_table_->Update(changes);
+        break;
+    }
+}
+
+TransportRouter::RouteInfo TransportRouter::ConvertRouteToRouteInfo(const graph::Router<double>::RouteInfo& route) const {
+    RouteInfo result;
+    result.total_time = route.weight;
+
+    // Подряд идущие рёбра поездки (в компактной модели — по одному на
+    // перегон) складываются в один элемент BUS; высадка элемента не даёт
+    bool riding = false;
+    for (const graph::EdgeId edge_id : route.edges) {
+        const auto& edge = graph_.GetEdge(edge_id);
+        const EdgeInfo& info = edge_info_[edge_id];
+        if (!info.bus) {
+            result.items.push_back({RouteItem::Type::WAIT, db_->GetStop(vertex_to_stop_[edge.from]).name, edge.weight, 0});
+            riding = false;
+        } else if (info.span_count == 0) {
+            riding = false;
+        } else if (riding) {
+            result.items.back().time += edge.weight;
+            result.items.back().span_count += info.span_count;
+        } else {
+            result.items.push_back({RouteItem::Type::BUS, info.bus->name, edge.weight, info.span_count});
+            riding = true;
+        }
+    }
+
+    return result;
+}
@@ -1,17 +1,86 @@
 #pragma once
 
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "graph.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "shortest_path_tree_cache.h"
+#include "landmarks.h"
+#include "contraction_hierarchy.h"
+#include "all_pairs_table.h"
+#include "parallel.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <optional>
 
+struct RoutingSettings {
+    // Способ поиска маршрутов в графе
+    enum class Strategy {
+        AUTO,       // Выбор по числу вершин и рёбер графа и memory_budget_bytes
+        ALL_PAIRS,  // Флойд–Уоршелл: все маршруты считаются при построении
+        DIJKSTRA,   // Поиск Дейкстры на каждый запрос
+        CONTRACTION_HIERARCHY,  // Иерархия сжатия: предрасчёт с сокращениями, быстрые запросы
+        ALL_PAIRS_COMPACT,      // Все маршруты в плоской таблице float + номер ребра, V поисков Дейкстры
+    };
+
+    // Нижняя оценка времени до цели для поиска A* в стратегии DIJKSTRA
+    enum class Heuristic {
+        NONE,       // Обычный поиск Дейкстры
+        GEO,        // Расстояние по прямой, делённое на скорость автобуса
+        LANDMARKS,  // ALT: оценки через предрасчитанные веса до опорных остановок
+    };
+
+    // Устройство графа маршрутов
+    enum class GraphModel {
+        PAIRWISE,  // Две вершины на остановку, ребро на каждую пару остановок автобуса
+        COMPACT,   // Вершина на остановку и на каждую позицию автобуса, рёбер O(числа остановок)
+    };
+
+    int bus_wait_time = 0;
+    double bus_velocity = 0.0;
+    Strategy strategy = Strategy::AUTO;
+    // Бюджет памяти на предрасчёт стратегии AUTO
+    size_t memory_budget_bytes = size_t{1} << 30;
+    GraphModel graph_model = GraphModel::PAIRWISE;
+    // Оставлять из рёбер автобусов между одной парой вершин только самое
+    // быстрое. Параллельные рёбра возникают в попарной модели, когда
+    // несколько автобусов проходят одни и те же остановки.
+    bool prune_parallel_edges = false;
+    // Убирать из графа проходные остановки: их обслуживает один автобус,
+    // проезжающий остановку один раз не в конце маршрута, так что пересадки
+    // там не бывает. Маршруты из них и в них достраиваются при запросе
+    // через соседние остановки автобуса, оставшиеся в графе.
+    bool compress_chains = false;
+    // Поиск DIJKSTRA по копии графа с целыми весами в миллисекундах и
+    // радикс-кучей вместо двоичной. Веса округляются вверх, так что маршрут
+    // длиннее кратчайшего не более чем на 1 мс на ребро; время в ответах
+    // считается по точным весам рёбер найденного маршрута.
+    bool fixed_point_weights = false;
+    // Лимит памяти под кэш деревьев кратчайших путей для DIJKSTRA, 0 — без кэша
+    size_t tree_cache_bytes = 0;
+    Heuristic heuristic = Heuristic::NONE;
+    // Число опорных остановок для Heuristic::LANDMARKS
+    size_t landmark_count = 16;
+    // Печатать в std::cerr сведения о построении графа и предрасчёта
+    bool log_stats = false;
+};
+
+// Маршрутизатор читает справочник только через свой снимок CatalogueSnapshot:
+// правки живого справочника на его ответы не влияют, пока новый снимок не
+// передан в UpdateCatalogue. Имена в ответах ссылаются на строки снимка.
+// Константные методы можно вызывать из нескольких потоков сразу, но не
+// одновременно с методами UpdateCatalogue, AddStop, AddBus, UpdateDistance
+// и UpdateSettings: правки применяются до запросов.
 class TransportRouter {
 public:
-    TransportRouter(const TransportCatalog::Transport::TransportCatalogue& db, int bus_wait_time, double bus_velocity);
+    TransportRouter(std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot> db,
+                    const RoutingSettings& settings);
+    // Строит маршрутизатор по снимку справочника db на момент вызова
+    TransportRouter(const TransportCatalog::Transport::TransportCatalogue& db, const RoutingSettings& settings);
     
     struct RouteItem {
         enum class Type { WAIT, BUS };
@@ -26,21 +95,279 @@ public:
         std::vector<RouteItem> items;
     };
 
+    struct ReachableStop {
+        std::string_view name;
+        double time;
+    };
+
+    // Ребро графа для сохранения в бинарный образ: вместо указателя на
+    // автобус — его номер, bus == std::nullopt у рёбер ожидания и посадки
+    struct ExportedEdge {
+        graph::VertexId from;
+        graph::VertexId to;
+        double weight;
+        std::optional<Domain::BusId> bus;
+        int span_count;
+    };
+
+    struct ExportedGraph {
+        std::vector<Domain::StopId> vertex_to_stop;
+        // NO_EXPORTED_VERTEX у остановок вне графа
+        std::vector<graph::VertexId> stop_to_vertex;
+        std::vector<ExportedEdge> edges;  // в порядке EdgeId
+    };
+
+    static constexpr graph::VertexId NO_EXPORTED_VERTEX = static_cast<graph::VertexId>(-1);
+
+    // Суммарные счётчики поисков в графе с момента построения. Стратегии
+    // с готовой таблицей весов поисков не выполняют; для иерархии сжатия
+    // пакет весов одной группы запросов считается одним поиском.
+    struct SearchStats {
+        size_t searches = 0;
+        size_t settled_vertices = 0;
+    };
+
     std::optional<RouteInfo> BuildRoute(std::string_view from, std::string_view to) const;
 
+    // Строит маршруты для пакета пар (откуда, куда). Запросы группируются по
+    // остановке отправления: на каждую различную остановку выполняется один
+    // поиск, группы обрабатываются параллельно. Для стратегии DIJKSTRA
+    // запрос, чья остановка назначения встречается в пакете чаще остановки
+    // отправления, решается обратным поиском — одним на остановку назначения.
+    // Ответы идут в порядке запросов.
+    std::vector<std::optional<RouteInfo>> BuildRoutes(
+        const std::vector<std::pair<std::string_view, std::string_view>>& requests) const;
+
+    // Матрица времени в пути между каждой остановкой origins и каждой
+    // остановкой destinations, построчно по origins. Для каждой остановки
+    // отправления выполняется один поиск; маршруты не восстанавливаются.
+    std::vector<std::optional<double>> BuildTravelTimeMatrix(
+        const std::vector<std::string_view>& origins, const std::vector<std::string_view>& destinations) const;
+
+    // Остановки, до которых можно добраться из from не дольше чем за max_time,
+    // по возрастанию времени. Поиск останавливается на границе max_time.
+    std::vector<ReachableStop> FindReachableStops(std::string_view from, double max_time) const;
+
+    // Счётчики кэша деревьев кратчайших путей
+    graph::ShortestPathTreeCache<double>::Stats GetTreeCacheStats() const;
+
+    SearchStats GetSearchStats() const;
+
+    // Печатает в std::cerr счётчики, накопленные при ответах на запросы,
+    // если задан RoutingSettings::log_stats
+    void LogQueryStats() const;
+
+    // Граф маршрутов без ссылок на справочник. Маршрут между остановками —
+    // путь между их вершинами, поэтому граф со сжатыми цепочками не выгружается.
+    ExportedGraph ExportGraph() const;
+
+    // Снимок справочника, по которому отвечает маршрутизатор
+    const std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot>& GetCatalogue() const;
+
+    // Изменения после построения. Справочник меняется вызывающим заранее,
+    // а его новый снимок передаётся в UpdateCatalogue до остальных методов;
+    // методы нельзя вызывать одновременно с поиском маршрутов.
+
+    // Переходит на более новый снимок того же справочника: остановки
+    // и автобусы в нём могут только добавиться. Граф не меняется.
+    void UpdateCatalogue(std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot> db);
+
+    // Пересчитывает рёбра автобусов, проходящих перегон между остановками
+    // from и to в любом направлении, после TransportCatalogue::SetDistance
+    void UpdateDistance(std::string_view from, std::string_view to);
+
+    // Добавляет в граф автобус из снимка вместе с его новыми остановками
+    void AddBus(std::string_view name);
+
+    // Добавляет в граф остановку из снимка, если её там ещё нет
+    void AddStop(std::string_view name);
+
+    // Применяет новые параметры маршрутизации. Граф перестраивается только
+    // при смене устройства графа (модель, отсечение рёбер, сжатие цепочек),
+    // при смене времени ожидания или скорости пересчитываются веса рёбер.
+    void UpdateSettings(const RoutingSettings& settings);
+
 private:
-    const TransportCatalog::Transport::TransportCatalogue& db_;
+    std::shared_ptr<const TransportCatalog::Transport::CatalogueSnapshot> db_;
     graph::DirectedWeightedGraph<double> graph_;
     std::unique_ptr<graph::Router<double>> router_;
+    std::unique_ptr<graph::DijkstraRouter<double>> dijkstra_router_;
+    // Поиск для RoutingSettings::fixed_point_weights: CSR-копия graph_
+    // с весами в миллисекундах, отдельный граф с целыми весами не хранится
+    std::unique_ptr<graph::DijkstraRouter<uint32_t, double>> fixed_point_router_;
+    // Поиск по обращённым рёбрам для пакетов, сходящихся к одной остановке
+    std::unique_ptr<graph::DijkstraRouter<double>> backward_router_;
+    std::unique_ptr<graph::DijkstraRouter<uint32_t, double>> fixed_point_backward_router_;
+    std::unique_ptr<graph::ShortestPathTreeCache<double>> tree_cache_;
+    std::unique_ptr<graph::LandmarkBounds<double>> landmarks_;
+    std::unique_ptr<graph::ContractionHierarchy<double>> contraction_hierarchy_;
+    std::unique_ptr<graph::AllPairsTable<double>> all_pairs_table_;
     
+    RoutingSettings settings_;
+    // Стратегия, по которой построен предрасчёт: settings_.strategy или
+    // выбранная для Strategy::AUTO
+    RoutingSettings::Strategy strategy_ = RoutingSettings::Strategy::ALL_PAIRS;
     int bus_wait_time_;
     double bus_velocity_;
+    // Минут на метр расстояния по прямой в геооценке A*
+    double geo_heuristic_scale_ = 0.0;
+
+    mutable std::atomic<size_t> searches_{0};
+    mutable std::atomic<size_t> settled_vertices_{0};
+    // Потоки для построения рёбер, пересчёта весов и пакетов запросов
+    mutable parallel::ThreadPool thread_pool_;
+
+    // Сведения о ребре графа, не зависящие от параметров маршрутизации:
+    // автобус (nullptr для ожидания), число пролётов и расстояние в метрах.
+    // В компактной модели число пролётов 0 у ребра высадки с автобуса.
+    struct EdgeInfo {
+        const Domain::Bus* bus;
+        int span_count;
+        double distance;
+    };
+
+    struct BusEdge {
+        graph::Edge<double> edge;
+        EdgeInfo info;
+    };
+
+    // Место автобуса в графе: рёбра автобуса идут подряд, в компактной
+    // модели подряд идут и его вершины. При отсечении параллельных рёбер
+    // диапазон рёбер не используется.
+    struct BusGraph {
+        const Domain::Bus* bus;
+        graph::VertexId first_vertex;
+        graph::EdgeId first_edge;
+        size_t edge_count;
+    };
+
+    using EdgeWeightChanges = std::vector<graph::EdgeWeightChange<double>>;
+
+    // Единиц целого веса в минуте: вес fixed_point_router_ в миллисекундах
+    static constexpr double FIXED_POINT_SCALE = 60000.0;
+
+    // Пределы Strategy::AUTO: таблица всех пар строится V поисками Дейкстры,
+    // а поиск на каждый запрос обходит до всех рёбер графа
+    static constexpr size_t AUTO_ALL_PAIRS_MAX_VERTICES = 4000;
+    static constexpr size_t AUTO_DIJKSTRA_MAX_EDGES = 500000;
+    // Байт иерархии сжатия на ребро графа: рёбра и примерно столько же
+    // сокращений, каждое в списке рёбер иерархии и в графе подъёма
+    static constexpr size_t CONTRACTION_HIERARCHY_BYTES_PER_EDGE = 2 * (6 * sizeof(size_t) + 3 * sizeof(size_t));
+    // Проход иерархии из одной вершины во все стоит примерно как два-три
+    // поиска между парой вершин при 100–2000 вершинах и дорожает с размером
+    // графа; поэтому он выбирается, когда нужных вершин не меньше
+    // CH_SWEEP_MIN_TARGETS и не меньше одной на CH_SWEEP_VERTICES_PER_TARGET
+    static constexpr size_t CH_SWEEP_MIN_TARGETS = 4;
+    static constexpr size_t CH_SWEEP_VERTICES_PER_TARGET = 1000;
+
+    // Связь проходной остановки с вершиной графа на том же автобусе:
+    // расстояние и число пролётов между ними
+    struct ChainLink {
+        graph::VertexId vertex;
+        double distance;
+        int span_count;
+    };
+
+    // Проходная остановка на одном направлении автобуса. Из неё можно
+    // доехать до вершин boardings, а в неё — из вершин alightings: в компактной
+    // модели это ближайшие позиции автобуса в графе, в попарной — все
+    // оставшиеся в графе остановки дальше (раньше) по направлению.
+    struct ChainStop {
+        const Domain::Bus* bus;
+        size_t direction;  // номер направления в GetBusDirections
+        size_t position;   // номер остановки в направлении
+        double offset;     // расстояние от начала направления
+        std::vector<ChainLink> boardings;
+        std::vector<ChainLink> alightings;
+    };
+
+    // Вершина графа, к которой присоединена остановка запроса: время между
+    // ними и участок поездки (bus == nullptr — остановка сама вершина графа)
+    struct GraphEndpoint {
+        graph::VertexId vertex;
+        double time;
+        const Domain::Bus* bus;
+        int span_count;
+    };
+
+    static constexpr graph::VertexId NO_VERTEX = NO_EXPORTED_VERTEX;
+    static constexpr size_t NO_BUS_INDEX = static_cast<size_t>(-1);
 
-    std::unordered_map<std::string_view, size_t> stop_to_vertex_;
-    std::vector<std::string_view> vertex_to_stop_;
+    // Вершина остановки по StopId; NO_VERTEX у проходных остановок и у
+    // остановок, добавленных в справочник позже графа
+    std::vector<graph::VertexId> stop_to_vertex_;
+    std::vector<Domain::StopId> vertex_to_stop_;
+    std::vector<Geo::Coordinates> vertex_coordinates_;
+    std::vector<EdgeInfo> edge_info_;  // индексируется EdgeId
+    std::vector<BusGraph> bus_graphs_;
+    // Номер в bus_graphs_ по BusId, NO_BUS_INDEX — автобус не в графе
+    std::vector<size_t> bus_to_index_;
+    // Первое ребро автобусов при отсечении параллельных рёбер: дальше идут
+    // только лучшие рёбра каждой пары вершин
+    graph::EdgeId first_pruned_edge_ = 0;
+    // Проходные остановки, убранные из графа при сжатии цепочек, по StopId
+    std::vector<bool> is_chain_stop_;
+    std::vector<std::vector<ChainStop>> chain_stops_;
+    size_t chain_stop_count_ = 0;
 
-    void BuildGraph();
-    std::string_view FindBusBetweenStops(std::string_view from, std::string_view to) const;
-    int CalculateSpansBetweenStops(std::string_view bus_name, std::string_view from, std::string_view to) const;
+    void BuildGraph(const std::vector<const Domain::Bus*>& buses);
+    std::vector<const Domain::Bus*> GetRoutedBuses() const;
+    void FindChainStops(const std::vector<const Domain::Bus*>& buses);
+    void BuildChainStops(const BusGraph& bus_graph);
+    bool IsChainStop(Domain::StopId stop) const;
+    bool IsKnownStop(Domain::StopId stop) const;
+    graph::VertexId GetStopVertex(Domain::StopId stop) const;
+    Domain::StopId FindKnownStop(std::string_view stop_name) const;
+    void BuildEngine();
+    RoutingSettings::Strategy ChooseStrategy() const;
+    size_t GetAutoTreeCacheBytes() const;
+    size_t EstimateMemoryUsage(RoutingSettings::Strategy strategy, size_t tree_cache_bytes) const;
+    static const char* GetStrategyName(RoutingSettings::Strategy strategy);
+    void BuildLandmarks();
+    static uint32_t ToFixedPoint(double weight);
+    static uint32_t ToFixedPointBound(double estimate);
+    std::optional<graph::Router<double>::RouteInfo> BuildFixedPointRoute(graph::VertexId from, graph::VertexId to) const;
+    graph::ShortestPathTree<double> ToExactTree(
+        graph::ShortestPathTree<uint32_t> fixed_point_tree,
+        graph::CsrDirection direction = graph::CsrDirection::OUTGOING,
+        const std::vector<GraphEndpoint>& sources = {}) const;
+    std::optional<graph::Router<double>::RouteInfo> BuildTreeRoute(
+        const graph::ShortestPathTree<double>& tree, graph::VertexId vertex,
+        graph::CsrDirection direction = graph::CsrDirection::OUTGOING) const;
+    void AddStopVertices(const Domain::Stop& stop);
+    graph::VertexId AddBusVertices(const Domain::Bus& bus);
+    void AddBusEdges(size_t bus_index, const std::vector<BusEdge>& edges);
+    std::vector<BusEdge> BuildBusEdges(const BusGraph& bus_graph) const;
+    std::vector<std::vector<BusEdge>> BuildAllBusEdges() const;
+    static std::vector<BusEdge> SelectCheapestParallelEdges(const std::vector<std::vector<BusEdge>>& bus_edges);
+    EdgeWeightChanges ReselectPrunedEdges();
+    void UpdateBusEdgeWeights(size_t bus_index, EdgeWeightChanges& changes);
+    double ComputeEdgeWeight(const EdgeInfo& info) const;
+    EdgeWeightChanges CustomizeWeights();
+    void LogContractionHierarchyStats() const;
+    void ApplyGraphChanges(const EdgeWeightChanges& changes, bool topology_changed);
+    std::vector<BusEdge> BuildPairwiseBusEdges(const Domain::Bus& bus) const;
+    std::vector<BusEdge> BuildCompactBusEdges(const Domain::Bus& bus, graph::VertexId first_vertex) const;
+    static std::vector<std::vector<Domain::StopId>> GetBusDirections(const Domain::Bus& bus);
+    std::vector<double> GetDirectionOffsets(const std::vector<Domain::StopId>& stops) const;
+    std::vector<size_t> GetGraphPositions(const std::vector<Domain::StopId>& stops) const;
+    std::vector<GraphEndpoint> GetSourceEndpoints(Domain::StopId stop) const;
+    std::vector<GraphEndpoint> GetTargetEndpoints(Domain::StopId stop) const;
+    std::optional<RouteInfo> BuildChainRoute(Domain::StopId from, Domain::StopId to) const;
+    std::optional<RouteInfo> BuildAttachedRoute(Domain::StopId from, Domain::StopId to) const;
+    std::vector<std::optional<double>> ComputeTravelTimes(
+        Domain::StopId from, const std::vector<Domain::StopId>& destinations,
+        const std::vector<std::vector<GraphEndpoint>>& destination_endpoints) const;
+    bool UseContractionHierarchySweep(size_t target_count) const;
+    std::optional<double> GetGraphRouteWeight(const graph::ShortestPathTree<double>* tree, graph::VertexId from,
+                                              graph::VertexId to, graph::SearchStats& stats) const;
+    std::optional<graph::Router<double>::RouteInfo> BuildGraphRoute(graph::VertexId from, graph::VertexId to) const;
+    std::shared_ptr<const graph::ShortestPathTree<double>> GetShortestPathTree(graph::VertexId from) const;
+    std::shared_ptr<const graph::ShortestPathTree<double>> GetSourceTree(const std::vector<GraphEndpoint>& sources) const;
+    graph::ShortestPathTree<double> BuildBackwardTree(graph::VertexId to) const;
+    bool IsStopVertex(graph::VertexId vertex) const;
+    double ComputeGeoHeuristicScale() const;
+    double EstimateTimeByGeo(graph::VertexId vertex, graph::VertexId to) const;
+    void CountSearch(const graph::SearchStats& stats) const;
     RouteInfo ConvertRouteToRouteInfo(const graph::Router<double>::RouteInfo& route) const;
 };
\ No newline at end of file